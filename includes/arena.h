@@ -0,0 +1,81 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/* Size of the blocks arenas are made of; larger allocations get a block of their own */
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+/* Alignment of every arena allocation */
+#define ARENA_ALIGN 16
+
+/**
+ * Arena - Bump allocator owned by one resource (a world cell, a baked mesh)
+ *
+ * Everything allocated from an arena is freed at once by `arena_release`.
+ * Arenas are recycled through a shared pool and keep their blocks while they
+ * sit in it, so after warm-up acquiring, filling and releasing an arena does
+ * not touch the system allocator at all.
+ *
+ * Functions taking an arena accept NULL to mean the ordinary heap, so code can
+ * serve both arena-owned and individually freed objects.
+ */
+typedef struct Arena Arena;
+
+/**
+ * arena_pool_init - Create the shared arena pool
+ * @arena_count: Arenas to allocate up front, one block each
+ *
+ * The pool grows past @arena_count when more arenas are in use at once.
+ */
+void arena_pool_init(int arena_count);
+
+/**
+ * arena_pool_free - Free the pool and every arena in it
+ *
+ * Arenas still acquired are not tracked and must have been released before.
+ */
+void arena_pool_free(void);
+
+/**
+ * arena_acquire - Take an empty arena from the pool
+ *
+ * Safe to call from any thread. Returns NULL only when out of memory.
+ */
+Arena* arena_acquire(void);
+
+/**
+ * arena_release - Free everything allocated from @arena and return it to the pool
+ * @arena: Arena to release (may be NULL)
+ *
+ * Constant time: the blocks stay attached to the arena for its next owner.
+ */
+void arena_release(Arena* arena);
+
+/**
+ * arena_alloc - Allocate @size bytes, aligned to ARENA_ALIGN
+ * @arena: Arena to allocate from, or NULL for the heap
+ * @size: Number of bytes
+ *
+ * Returns NULL when out of memory. An arena must only be used by one thread at a time.
+ */
+void* arena_alloc(Arena* arena, size_t size);
+
+/**
+ * arena_calloc - Like `arena_alloc`, for @count zeroed items of @size bytes
+ */
+void* arena_calloc(Arena* arena, size_t count, size_t size);
+
+/**
+ * arena_free - Free @ptr if it came from the heap; arena memory is only freed by `arena_release`
+ * @arena: Arena @ptr was allocated from, or NULL for the heap
+ * @ptr: Allocation to free (may be NULL)
+ */
+void arena_free(Arena* arena, void* ptr);
+
+/**
+ * arena_used - Bytes handed out by @arena since it was acquired
+ */
+size_t arena_used(const Arena* arena);
+
+#endif // !ARENA_H
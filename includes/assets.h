@@ -0,0 +1,154 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include "generated/Blob.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/* Pack opened by `game_init`, looked up in the working directory */
+#define ASSET_PACK_FILE "glyphborn.gbpak"
+
+/* "GBPK" */
+#define ASSET_PACK_MAGIC	0x4B504247
+#define ASSET_PACK_VERSION	1
+
+/* Every entry of a pack starts on this boundary, like the embedded blobs */
+#define ASSET_PACK_ALIGN	16
+
+/**
+ * AssetKind - Kinds of world data; ids are per kind
+ */
+typedef enum AssetKind
+{
+	ASSET_GEOMETRY,
+	ASSET_COLLISION,
+	ASSET_TILESET_REGIONAL,
+	ASSET_TILESET_LOCAL,
+	ASSET_TILESET_INTERIOR,
+	ASSET_WORLD_MATRIX,		// id 0 only
+	ASSET_WORLD_HEADERS,	// id 0 only
+	ASSET_KIND_COUNT,
+} AssetKind;
+
+/**
+ * AssetPackHeader - Start of a .gbpak file
+ * @magic: ASSET_PACK_MAGIC
+ * @version: ASSET_PACK_VERSION
+ * @align: Alignment of every entry's data, a multiple of ASSET_PACK_ALIGN
+ * @entry_count: Number of `AssetPackEntry` records in the table of contents
+ * @toc_checksum: CRC-32 of the table of contents
+ * @toc_offset: Byte offset of the table of contents
+ * @file_size: Size of the whole file
+ *
+ * All fields are little-endian. The table of contents lists entries sorted by
+ * (kind, id); the data of the entries lies between the header and the table.
+ */
+typedef struct AssetPackHeader
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t align;
+	uint32_t entry_count;
+	uint32_t toc_checksum;
+	uint64_t toc_offset;
+	uint64_t file_size;
+} AssetPackHeader;
+
+/**
+ * AssetPackEntry - One blob of a pack
+ * @kind: `AssetKind`
+ * @id: Index of the blob within its kind, as in the registry
+ * @checksum: CRC-32 of the data, checked the first time the entry is used
+ * @offset, @size: Location of the data in the file
+ */
+typedef struct AssetPackEntry
+{
+	uint16_t kind;
+	uint16_t id;
+	uint32_t checksum;
+	uint64_t offset;
+	uint64_t size;
+} AssetPackEntry;
+
+_Static_assert(sizeof(AssetPackHeader) == 32, "AssetPackHeader layout is part of the file format");
+_Static_assert(sizeof(AssetPackEntry) == 24, "AssetPackEntry layout is part of the file format");
+
+/**
+ * assets_open - Map an asset pack and index its table of contents
+ * @path: Pack file
+ *
+ * Only the header and the table of contents are read, so this is instant;
+ * entry data is paged in by the OS when a blob is first used. Once a pack is
+ * open, lookups are served from it; otherwise they fall back to the blobs
+ * linked into the executable, unless it was built with GB_ASSET_PACK.
+ *
+ * Return: false if the file is missing or its header or table is invalid.
+ */
+bool assets_open(const char* path);
+
+/**
+ * assets_close - Unmap the open pack
+ *
+ * Every blob obtained from it becomes invalid.
+ */
+void assets_close(void);
+
+/**
+ * asset_get - Blob @id of @kind
+ *
+ * Safe to call from any thread. The first lookup of a pack entry verifies its
+ * checksum.
+ *
+ * Return: NULL when there is no such blob or it is corrupt.
+ */
+const Blob* asset_get(AssetKind kind, uint16_t id);
+
+/**
+ * AssetLocation - Where a pack entry lies on disk
+ * @file: The open pack, for `async_io_submit`
+ * @offset, @size: Byte range of the entry's data
+ */
+typedef struct AssetLocation
+{
+	struct AsyncFile* file;
+	uint64_t offset;
+	size_t size;
+} AssetLocation;
+
+/**
+ * asset_locate - Find blob @id of @kind in the open pack, to read it without the mapping
+ *
+ * Return: false when no pack is open (embedded data needs no reading) or the
+ * entry does not exist.
+ */
+bool asset_locate(AssetKind kind, uint16_t id, AssetLocation* location);
+
+/**
+ * asset_verify - Check a copy of blob @id of @kind against the pack's checksum
+ * @data, @size: The copy, e.g. read at `asset_locate`
+ *
+ * An entry already known to be valid or corrupt is not checksummed again.
+ */
+bool asset_verify(AssetKind kind, uint16_t id, const uint8_t* data, size_t size);
+
+/**
+ * asset_count - One past the highest id of @kind
+ */
+size_t asset_count(AssetKind kind);
+
+/**
+ * assets_map_file - Map a whole file read-only (implemented in `assets_linux.c` / `assets_windows.c`)
+ * @path: File to map
+ * @size: Receives the file size
+ *
+ * Return: NULL if the file cannot be opened or mapped, or is empty.
+ */
+const uint8_t* assets_map_file(const char* path, size_t* size);
+
+/**
+ * assets_unmap_file - Undo `assets_map_file`
+ */
+void assets_unmap_file(const uint8_t* data, size_t size);
+
+#endif // !ASSETS_H
@@ -0,0 +1,140 @@
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Batched asynchronous file reads.
+ *
+ * On Linux reads go through an io_uring ring (set up with raw syscalls, no
+ * liburing) when the kernel allows it. Otherwise, and on Windows, a small
+ * pool of threads performs blocking positional reads. Either way the caller
+ * hands over a batch and is called back once every read in it has finished.
+ */
+
+/* Threads of the blocking fallback */
+#define ASYNC_IO_THREADS 2
+
+/* Ring size; reads beyond it wait in the fallback pool instead */
+#define ASYNC_IO_RING_DEPTH 64
+
+typedef struct AsyncFile AsyncFile;
+typedef struct AsyncBatch AsyncBatch;
+
+/**
+ * AsyncRead - One read of a batch
+ * @file: File to read from
+ * @offset: Byte offset in @file
+ * @size: Bytes to read
+ * @buffer: Receives the data; must stay valid until the batch completes
+ * @tag: Caller's label for the read, unused by the I/O layer
+ * @ok: Set on completion: all @size bytes were read
+ * @batch, @next: Internal
+ */
+typedef struct AsyncRead
+{
+	AsyncFile* file;
+	uint64_t offset;
+	size_t size;
+	void* buffer;
+	uint32_t tag;
+	bool ok;
+
+	AsyncBatch* batch;
+	struct AsyncRead* next;
+} AsyncRead;
+
+typedef void (*AsyncBatchFunc)(AsyncBatch* batch);
+
+/**
+ * AsyncBatch - Reads completed together
+ * @reads, @count: The reads
+ * @done: Called once, on an I/O thread, when every read has finished; the
+ *        batch belongs to the caller again from then on
+ * @user: Opaque pointer for @done
+ * @pending: Internal
+ */
+struct AsyncBatch
+{
+	AsyncRead* reads;
+	int count;
+	AsyncBatchFunc done;
+	void* user;
+
+	atomic_int pending;
+};
+
+/**
+ * async_io_init - Start the I/O threads
+ * @use_ring: Try io_uring first; false forces the thread pool
+ */
+void async_io_init(bool use_ring);
+
+/**
+ * async_io_shutdown - Wait for every submitted batch, then stop the I/O threads
+ */
+void async_io_shutdown(void);
+
+/**
+ * async_io_backend - Name of the backend in use ("io_uring", "threads" or "none")
+ */
+const char* async_io_backend(void);
+
+/**
+ * async_io_submit - Start the reads of @batch
+ *
+ * Safe to call from any thread. @batch->done may run before this returns.
+ * Without `async_io_init` the reads are done right here.
+ */
+void async_io_submit(AsyncBatch* batch);
+
+/**
+ * async_io_run - Do the reads of @batch on the calling thread; @batch->done is not called
+ */
+void async_io_run(AsyncBatch* batch);
+
+/**
+ * async_file_open - Open a file for reading
+ *
+ * Return: NULL if it cannot be opened.
+ */
+AsyncFile* async_file_open(const char* path);
+void async_file_close(AsyncFile* file);
+
+/*
+ * Platform layer (implemented in `async_io_linux.c` / `async_io_windows.c`)
+ */
+
+/**
+ * async_file_read_at - Blocking read of exactly @size bytes at @offset
+ */
+bool async_file_read_at(AsyncFile* file, uint64_t offset, void* buffer, size_t size);
+
+/**
+ * async_io_ring_start - Set up the kernel ring and its completion thread
+ *
+ * Return: false when the platform or kernel has no usable ring.
+ */
+bool async_io_ring_start(unsigned depth);
+
+/**
+ * async_io_ring_submit - Queue @read on the ring
+ *
+ * Return: false if the ring is full or cannot take the read.
+ */
+bool async_io_ring_submit(AsyncRead* read);
+
+/**
+ * async_io_ring_stop - Stop the completion thread and free the ring; nothing may be in flight
+ */
+void async_io_ring_stop(void);
+
+/**
+ * async_io_complete - Report a finished read to its batch (called by the backends)
+ */
+void async_io_complete(AsyncRead* read, bool ok);
+
+#endif // !ASYNC_IO_H
@@ -11,6 +11,33 @@ typedef struct
 	Vec3 up;
 } Camera;
 
+/**
+ * CameraCardinal - Horizontal direction the camera faces
+ * @CAMERA_NORTH: Towards -Z (map y - 1)
+ * @CAMERA_EAST: Towards +X (map x + 1)
+ * @CAMERA_SOUTH: Towards +Z (map y + 1)
+ * @CAMERA_WEST: Towards -X (map x - 1)
+ */
+typedef enum
+{
+	CAMERA_NORTH,
+	CAMERA_EAST,
+	CAMERA_SOUTH,
+	CAMERA_WEST,
+	CAMERA_CARDINAL_COUNT
+} CameraCardinal;
+
 Mat4 camera_get_view_matrix(Camera* cam);
 
+/**
+ * camera_cardinal - Cardinal direction closest to the view direction of @view
+ * @view: View matrix, e.g. from `camera_get_view_matrix`
+ */
+CameraCardinal camera_cardinal(Mat4 view);
+
+/**
+ * camera_cardinal_forward - Unit world-space vector pointing towards @facing
+ */
+Vec3 camera_cardinal_forward(CameraCardinal facing);
+
 #endif // !CAMERA_H
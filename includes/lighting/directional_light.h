@@ -9,4 +9,22 @@ typedef struct DirectionalLight {
     float intensity;
 } DirectionalLight;
 
-#endif // !DIRECTIONAL_LIGHT_H
\ No newline at end of file
+/**
+ * directional_light_face_normal - Unit normal of the triangle (a, b, c)
+ * @a, @b, @c: Triangle corners; counter-clockwise winding faces the normal
+ *
+ * Returns the zero vector for degenerate triangles, which
+ * `directional_light_factor` lights with ambient only.
+ */
+Vec3 directional_light_face_normal(Vec3 a, Vec3 b, Vec3 c);
+
+/**
+ * directional_light_factor - Brightness of a surface facing @normal
+ * @light: Light to evaluate
+ * @normal: Unit surface normal, or the zero vector
+ *
+ * Returns ambient + max(0, normal . -dir) * intensity, clamped to [0, 1].
+ */
+float directional_light_factor(const DirectionalLight* light, Vec3 normal);
+
+#endif // !DIRECTIONAL_LIGHT_H
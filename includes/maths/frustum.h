@@ -0,0 +1,34 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <stdbool.h>
+#include "vec3.h"
+#include "vec4.h"
+#include "mat4.h"
+
+/**
+ * Frustum - The six clip planes of a projection, as (a, b, c, d) with
+ *           a*x + b*y + c*z + d >= 0 on the inside
+ */
+typedef struct
+{
+	Vec4 planes[6];
+} Frustum;
+
+/**
+ * frustum_from_matrix - Extract the clip planes of @clip
+ * @clip: Matrix taking points to clip space, e.g. projection * view * model;
+ *        the planes are then expressed in the space @clip takes its input from
+ */
+Frustum frustum_from_matrix(Mat4 clip);
+
+/**
+ * frustum_intersects_aabb - Conservative box test
+ * @frustum: Planes to test against
+ * @min, @max: Box corners
+ *
+ * Returns false only if the box lies entirely outside one of the planes.
+ */
+bool frustum_intersects_aabb(const Frustum* frustum, Vec3 min, Vec3 max);
+
+#endif // !FRUSTUM_H
@@ -1,15 +1,39 @@
 #ifndef RENDER_MAP_H
 #define RENDER_MAP_H
 
-#include "world/world_geometry.h"
-#include "world/world_tileset.h"
+#include "world/world_mesh.h"
+#include "world/world_lod.h"
 #include "maths/mat4.h"
+#include "camera.h"
+#include <stdbool.h>
 
+/**
+ * render_map - Draw the bricks of a baked cell that intersect the view frustum
+ * @mesh: Cell mesh
+ * @model, @view, @projection: Transform matrices
+ * @facing: Camera direction, picks which of `mesh->views` to draw
+ * @front_to_back: true to draw bricks nearest-first along @facing; false for
+ *                 brick index order
+ *
+ * Bricks whose face list lies entirely in front of the eye (`ChunkFacing`)
+ * are drawn without per-triangle back-face culling.
+ */
 void render_map(
-    const GeometryMap* geo,
-    const Tileset* regional,
-    const Tileset* local,
-    const Tileset* interior,
+    const ChunkMesh* mesh,
+    Mat4 model,
+    Mat4 view,
+    Mat4 projection,
+    CameraCardinal facing,
+    bool front_to_back
+);
+
+/**
+ * render_lod - Draw the simplified mesh of a distant cell
+ * @mesh: LOD mesh; lit per face from the global sun
+ * @model, @view, @projection: Transform matrices
+ */
+void render_lod(
+    const LodMesh* mesh,
     Mat4 model,
     Mat4 view,
     Mat4 projection
@@ -16,26 +16,68 @@ typedef struct RasterVertex
     float u, v;
 } RasterVertex;
 
+/**
+ * RasterCull - Which triangles `sketch_draw_mesh` may discard by winding
+ * @RASTER_CULL_NONE: Draw both sides (default for zero-initialized meshes)
+ * @RASTER_CULL_CW: Front faces appear counter-clockwise to the viewer; drop clockwise triangles
+ * @RASTER_CULL_CCW: Front faces appear clockwise to the viewer; drop counter-clockwise triangles
+ */
+typedef enum RasterCull
+{
+    RASTER_CULL_NONE = 0,
+    RASTER_CULL_CW,
+    RASTER_CULL_CCW,
+} RasterCull;
+
+/**
+ * RasterTexture - RGBA32 texture referenced by a mesh
+ * @pixels: Pixel data (read-only)
+ * @width, @height: Texture dimensions
+ * @wrap: Repeat the texture outside [0, 1] instead of clamping to its edges
+ */
+typedef struct RasterTexture
+{
+    const uint32_t* pixels;
+    uint16_t width;
+    uint16_t height;
+    bool wrap;
+} RasterTexture;
+
 /**
  * RasterMesh - CPU-side mesh representation for `sketch_draw_mesh`
  * @vertices: Pointer to array of `RasterVertex` (read-only)
  * @vertex_count: Number of vertices
  * @indices: Triangle index array (3 indices per triangle)
  * @index_count: Number of indices
- * @pixels: Pointer to RGBA32 texture pixel data (read-only)
+ * @pixels: Pointer to RGBA32 texture pixel data (read-only), used when @face_textures is NULL
  * @tex_width, @tex_height: Texture dimensions
+ * @textures: Optional texture palette
+ * @face_textures: Optional index into @textures per triangle; faces with an empty texture are skipped
+ * @cull: Back-face culling mode; only meshes with a consistent winding should opt in
+ * @face_light: Optional precomputed light factors; when NULL, faces are lit from
+ *              their world-space normal and the global sun
+ * @face_light_ids: Optional index into @face_light per triangle; when NULL,
+ *                  @face_light holds one entry per triangle
  */
 typedef struct RasterMesh
 {
     const RasterVertex* vertices;
     uint32_t vertex_count;
 
-    const uint16_t* indices;
+    const uint32_t* indices;
     uint32_t index_count;
 
     const uint32_t* pixels;
     uint16_t tex_width;
     uint16_t tex_height;
+
+    const RasterTexture* textures;
+    const uint16_t* face_textures;
+
+    RasterCull cull;
+
+    const float* face_light;
+    const uint16_t* face_light_ids;
 } RasterMesh;
 
 /**
@@ -44,6 +86,15 @@ typedef struct RasterMesh
  */
 void sketch_show_uvs(bool showUVs);
 
+/**
+ * sketch_set_simd - Allow or forbid the vectorized span kernels
+ * @enabled: true to pick the best kernel the CPU supports (AVX2, then SSE2), false for scalar only
+ *
+ * The kernel is chosen at runtime via CPUID; all kernels produce identical pixels,
+ * so this only exists for profiling and debugging. SIMD is enabled by default.
+ */
+void sketch_set_simd(bool enabled);
+
 /**
  * sketch_clear - Clear the game framebuffer and reset the depth buffer
  * @clear_color: ARGB color used to clear framebuffer_game
@@ -55,9 +106,30 @@ void sketch_clear(uint32_t clear_color);
  * @mesh: Mesh to draw (read-only)
  * @model, @view, @projection: Matrices applied in order to vertices before clipping
  *
- * This function performs clip-space near-plane clipping, perspective divide, viewport
- * transform and perspective-correct interpolation of UVs before rasterizing triangles.
+ * Triangles entirely outside one frustum plane, or back-facing according to
+ * `mesh->cull`, are discarded first. The rest go through clip-space near-plane
+ * clipping, perspective divide, viewport transform and perspective-correct
+ * interpolation of UVs before being rasterized.
+ * In binned mode the triangles are only queued; call `sketch_flush` to rasterize them.
  */
 void sketch_draw_mesh(const RasterMesh* mesh, Mat4 model, Mat4 view, Mat4 projection);
 
+/**
+ * sketch_set_binned - Toggle tile-binned rasterization
+ * @enabled: true to queue triangles into 32x32 screen tiles, false to draw immediately
+ *
+ * Binned triangles are rasterized by the worker pool (see `workers.h`) when
+ * `sketch_flush` is called. The output is bit-identical to the immediate path.
+ * Disabling binned mode flushes anything still queued.
+ */
+void sketch_set_binned(bool enabled);
+
+/**
+ * sketch_flush - Rasterize all queued triangles in parallel and empty the queue
+ *
+ * Textures referenced by queued meshes must stay alive until this returns.
+ * Does nothing when the queue is empty (always the case outside binned mode).
+ */
+void sketch_flush(void);
+
 #endif // !SKETCH_H
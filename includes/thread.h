@@ -0,0 +1,55 @@
+#ifndef THREAD_H
+#define THREAD_H
+
+#include <stdbool.h>
+
+/**
+ * Thin platform threading layer (implemented in `thread_linux.c` / `thread_windows.c`).
+ *
+ * All handles are opaque and heap-allocated by their create function; destroy/join
+ * releases them.
+ */
+typedef struct Thread Thread;
+typedef struct Mutex Mutex;
+typedef struct CondVar CondVar;
+
+typedef void (*ThreadFunc)(void* user);
+
+/**
+ * thread_create - Start a new OS thread
+ * @func: Entry point invoked on the new thread
+ * @user: Opaque pointer passed to @func
+ *
+ * Returns NULL if the thread could not be started.
+ */
+Thread* thread_create(ThreadFunc func, void* user);
+
+/**
+ * thread_join - Wait for a thread to finish and release its handle
+ * @thread: Thread returned by `thread_create` (may be NULL)
+ */
+void thread_join(Thread* thread);
+
+/**
+ * thread_hardware_concurrency - Number of logical processors available (at least 1)
+ */
+int thread_hardware_concurrency(void);
+
+Mutex* mutex_create(void);
+void mutex_destroy(Mutex* mutex);
+void mutex_lock(Mutex* mutex);
+void mutex_unlock(Mutex* mutex);
+
+CondVar* condvar_create(void);
+void condvar_destroy(CondVar* cond);
+
+/**
+ * condvar_wait - Atomically release @mutex and block until signalled
+ * @cond: Condition variable to wait on
+ * @mutex: Locked mutex; it is locked again when this returns
+ */
+void condvar_wait(CondVar* cond, Mutex* mutex);
+void condvar_signal(CondVar* cond);
+void condvar_broadcast(CondVar* cond);
+
+#endif // !THREAD_H
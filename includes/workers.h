@@ -0,0 +1,45 @@
+#ifndef WORKERS_H
+#define WORKERS_H
+
+#include <stdint.h>
+
+#define WORKERS_MAX 32
+
+/**
+ * WorkerJob - Callback invoked once per item of a `workers_run` batch
+ * @user: Opaque pointer passed to `workers_run`
+ * @index: Item index in [0, count)
+ */
+typedef void (*WorkerJob)(void* user, uint32_t index);
+
+/**
+ * workers_init - Start the shared worker pool
+ * @thread_count: Number of background threads; 0 picks one per extra logical core
+ *
+ * The calling thread always takes part in `workers_run`, so a pool of zero threads
+ * is valid and simply runs every batch serially.
+ */
+void workers_init(int thread_count);
+
+/**
+ * workers_run - Run @job for every index in [0, @count) and wait for completion
+ * @job: Item callback, called concurrently from several threads
+ * @user: Opaque pointer passed to @job
+ * @count: Number of items
+ *
+ * Items are handed out dynamically, so callers must not rely on any ordering
+ * between items. Must only be called from the thread that called `workers_init`.
+ */
+void workers_run(WorkerJob job, void* user, uint32_t count);
+
+/**
+ * workers_count - Number of threads that execute a batch (background threads + caller)
+ */
+int workers_count(void);
+
+/**
+ * workers_shutdown - Stop and join all worker threads
+ */
+void workers_shutdown(void);
+
+#endif // !WORKERS_H
@@ -6,26 +6,54 @@
 #include "world/world_geometry.h"
 #include "world/world_collision.h"
 #include "world/world_tileset.h"
+#include "world/world_mesh.h"
+#include "world/world_lod.h"
 #include "maths/mat4.h"
 #include "render_map.h"
 #include <stdint.h>
+#include <math.h>
+#include <stdbool.h>
 
-#define WORLD_RADIUS 1      // 3x3 grid around player
+/* Default radii, in cells around the player (Chebyshev distance) */
+#define WORLD_RADIUS 1      // 3x3 grid of full-detail cells
+#define WORLD_LOD_RADIUS 3  // 7x7; cells outside the render radius use LOD meshes
+
+/**
+ * WorldRadii - How far around the center cell the world is kept and drawn
+ * @load: Full-detail cells kept loaded (geometry, collision, tilesets)
+ * @render: Full-detail cells drawn; at most @load. Cells between the two are
+ *          simulated but not drawn, e.g. for a server or a low-end client
+ * @lod: Cells drawn as LOD meshes beyond @render; no LOD ring when not above @render
+ *
+ * The grids are (2 * @load + 1)^2 and (2 * @lod + 1)^2 slots, allocated by
+ * `world_init`.
+ */
+typedef struct WorldRadii {
+    int load;
+    int render;
+    int lod;
+} WorldRadii;
+
+#define WORLD_RADII_DEFAULT ((WorldRadii){ WORLD_RADIUS, WORLD_RADIUS, WORLD_LOD_RADIUS })
 
 /**
  * WorldCell - Represents a single map cell loaded around the player.
  * @header_id: ID referencing a world header entry.
- * @geometry: Pointer to loaded geometry map (ownership: caller frees via geometry_free).
- * @collision: Pointer to loaded collision map (ownership: caller frees via collision_free).
+ * @arena: Arena holding @geometry and @collision; released when the cell unloads.
+ * @geometry: Pointer to loaded geometry map, allocated from @arena.
+ * @collision: Pointer to loaded collision map, allocated from @arena.
  * @local_tileset: Pointer to the local tileset for the cell.
  * @regional_tileset: Pointer to the regional tileset for the cell.
  * @interior_tileset: Pointer to the interior tileset for the cell.
+ * @mesh: Baked geometry of the cell, rebuilt whenever `geometry` changes.
  * @world_x, @world_y: Coordinates of this cell in world matrix space.
  * @vertical_offset: Y offset applied when rendering this cell.
+ * @loaded: Whether this slot holds a cell; false for slots not yet streamed in.
  */
 typedef struct WorldCell {
     uint16_t header_id;
 
+    Arena* arena;
     GeometryMap* geometry;
     CollisionMap* collision;
 
@@ -33,31 +61,93 @@ typedef struct WorldCell {
     Tileset* regional_tileset;
     Tileset* interior_tileset;
 
+    ChunkMesh mesh;
+
     int world_x;
     int world_y;
     int16_t vertical_offset;
+    bool loaded;
 } WorldCell;
 
+/**
+ * WorldLodCell - A distant cell, kept only as its LOD mesh.
+ * @header_id: ID referencing a world header entry.
+ * @world_x, @world_y: Coordinates of this cell in world matrix space.
+ * @vertical_offset: Y offset applied when rendering this cell.
+ * @loaded: Whether this slot holds a cell.
+ * @mesh: Heightmap built from the cell's geometry at load; the geometry and
+ *        tilesets themselves are released right after.
+ */
+typedef struct WorldLodCell {
+    uint16_t header_id;
+
+    int world_x;
+    int world_y;
+    int16_t vertical_offset;
+    bool loaded;
+
+    LodMesh mesh;
+} WorldLodCell;
+
 /**
  * World - The active world context centered on the player.
  * @cx, @cy: Current center cell coordinates in world space.
- * @cells: 3x3 grid of loaded `WorldCell` objects (WORLD_RADIUS defines radius).
+ * @radii: Radii the grids were sized for (already clamped).
+ * @diameter, @lod_diameter: Side of @cells and @lod in slots.
+ * @cells: Toroidal grid of loaded `WorldCell` objects; the cell at matrix
+ *         coordinates (x, y) lives in cells[(y mod @diameter) * @diameter + x mod @diameter].
+ * @lod: LOD ring around the drawn cells, a toroidal grid like @cells but
+ *       @lod_diameter wide; slots of cells inside `radii.render` are unused.
  */
 typedef struct World {
     int cx;     // center map x
     int cy;     // center map y
 
-    WorldCell cells[3][3];  // 3x3 grid
+    WorldRadii radii;
+    int diameter;
+    int lod_diameter;
+
+    WorldCell* cells;
+    WorldLodCell* lod;
 } World; 
 
+/**
+ * WorldDrawOrder - Order in which `world_render` submits geometry
+ * @WORLD_DRAW_FIXED: Cells row by row; within a cell, bricks in index order
+ * @WORLD_DRAW_FRONT_TO_BACK: Cells and bricks nearest-first along the camera's
+ *                            cardinal direction, so more pixels fail the depth
+ *                            test before being shaded (default)
+ *
+ * Either way each brick draws its triangles from the direction's face list,
+ * nearest-first.
+ */
+typedef enum WorldDrawOrder {
+    WORLD_DRAW_FIXED,
+    WORLD_DRAW_FRONT_TO_BACK,
+} WorldDrawOrder;
+
+/**
+ * world_cell_coord - Cell coordinate (world matrix space) of a world position
+ * @position: World X or Z position, in tiles
+ * @size: Cell size along that axis, MAP_WIDTH or MAP_HEIGHT
+ */
+static inline int world_cell_coord(float position, int size)
+{
+    return (int)floorf(position / (float)size);
+}
+
 // Initialization
 /**
  * world_init - Initialize the world grid and load initial cells.
  * @world: Pointer to an allocated World struct to initialize.
- * @start_x: Initial player world X coordinate to center the grid on.
- * @start_y: Initial player world Y coordinate to center the grid on.
+ * @start_x: Matrix X of the cell to center the grid on; for a world position,
+ *           `world_cell_coord(x, MAP_WIDTH)`, as `world_update` computes it.
+ * @start_y: Matrix Y of the cell to center the grid on (`world_cell_coord(z, MAP_HEIGHT)`).
+ * @radii: Streaming and drawing radii, or NULL for `WORLD_RADII_DEFAULT`.
+ *         Negative radii are raised to 0 and @radii->render is capped at
+ *         @radii->load.
  */
-void world_init(World* world, int start_x, int start_y);
+void world_init(World* world, int start_x, int start_y, const WorldRadii* radii);
 
 // Update (player movement)
 /**
@@ -66,20 +156,27 @@ void world_init(World* world, int start_x, int start_y);
  * @player_x: Player X position in world units.
  * @player_z: Player Z position in world units.
  *
- * Recomputes the center cell; if center changes, unloads and reloads
- * the surrounding 3x3 grid to keep the player-centric area populated.
+ * Recomputes the center cell; if center changes, only the cells that
+ * entered the grid (and the LOD ring) are loaded, into the slots of
+ * the ones that left it. Everything else stays in place.
  */
 void world_update(World* world, float player_x, float player_z);
 
 // Render
 /**
- * world_render - Render all loaded cells.
+ * world_render - Render the loaded cells within the render radius, then the LOD ring.
  * @world: Pointer to World instance.
  * @view: View matrix.
  * @projection: Projection matrix.
  */
 void world_render(World* world, Mat4 view, Mat4 projection);
 
+/**
+ * world_set_draw_order - Choose how `world_render` orders cells and triangles
+ * @order: New order; only affects speed, not the final image (up to depth ties)
+ */
+void world_set_draw_order(WorldDrawOrder order);
+
 // Cleanup
 /**
  * world_free - Free all resources held by the world, including loaded maps and tilesets.
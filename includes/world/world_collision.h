@@ -2,18 +2,72 @@
 #define WORLD_COLLISION_H
 
 #include <stdint.h>
-#include "generated/Collision.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include "assets.h"
+#include "world/world_packed.h"
 
 #define COLLISION_MAGIC 0x434D4247   // "GBMC"
 #define MAP_WIDTH   32
 #define MAP_HEIGHT  32
 #define MAP_LAYERS  32
 
+/**
+ * CollisionMap - Collision flags of one cell
+ * @storage: MAP_STORAGE_VIEW or MAP_STORAGE_PACKED; collision is never edited
+ * @tiles: Flags indexed [(layer * MAP_HEIGHT + y) * MAP_WIDTH + x], pointing
+ *         into the blob; NULL when packed
+ * @packed: Per-layer palette-packed flags, used when @tiles is NULL
+ * @arena: Arena holding the map and its packed layers, or NULL for the heap
+ */
 typedef struct CollisionMap {
-    char tiles[MAP_LAYERS][MAP_HEIGHT][MAP_WIDTH];
+    MapStorage storage;
+    const uint8_t* tiles;
+    PackedLayer packed[MAP_LAYERS];
+    Arena* arena;
 } CollisionMap;
 
-CollisionMap* collision_load(uint16_t collision_id);
+/**
+ * collision_load - Load the collision flags of a cell
+ * @collision_id: `ASSET_COLLISION` id
+ * @arena: Arena for the map and its packed layers, or NULL for the heap
+ *
+ * Nothing is copied; the map is a view of the embedded blob.
+ */
+CollisionMap* collision_load(uint16_t collision_id, Arena* arena);
+
+/**
+ * collision_parse - Load the collision flags of a cell from a blob already in memory
+ * @blob: Collision blob (may be NULL)
+ * @arena: As for `collision_load`
+ * @borrow: Whether the map may point into @blob, which must then outlive it.
+ *          Otherwise the flags are palette-packed (MAP_STORAGE_PACKED) and
+ *          @blob may be freed on return.
+ */
+CollisionMap* collision_parse(const Blob* blob, Arena* arena, bool borrow);
+
+/**
+ * collision_free - Free a map loaded onto the heap
+ * @map: Map to free (may be NULL); arena maps are left to `arena_release`
+ */
 void collision_free(CollisionMap* map);
 
+/**
+ * collision_bytes - Memory held by @map, including the struct itself
+ */
+size_t collision_bytes(const CollisionMap* map);
+
+/**
+ * collision_get - Collision flags at (@layer, @y, @x)
+ *
+ * Coordinates must be in range.
+ */
+static inline uint8_t collision_get(const CollisionMap* map, int layer, int y, int x)
+{
+    if (map->tiles)
+        return map->tiles[(layer * MAP_HEIGHT + y) * MAP_WIDTH + x];
+
+    return (uint8_t)packed_layer_get(&map->packed[layer], (uint32_t)(y * MAP_WIDTH + x));
+}
+
 #endif // !WORLD_COLLISION_H
\ No newline at end of file
@@ -2,7 +2,9 @@
 #define WORLD_GEOMETRY_H
 
 #include <stdint.h>
-#include "generated/Geometry.h"
+#include <stdbool.h>
+#include "assets.h"
+#include "world/world_packed.h"
 
 #define GEOMETRY_MAGIC 0x474D4247   // "GBMG"
 #define MAP_WIDTH   32
@@ -13,13 +15,129 @@ typedef struct TileRef {
     uint16_t packed;
 } TileRef;
 
+/* Reference 0 (regional tile 0) is air */
+#define TILE_AIR 0
+
+_Static_assert(MAP_WIDTH == 32, "occupancy rows are 32-bit words");
+_Static_assert(MAP_WIDTH * MAP_HEIGHT == PACKED_LAYER_SIZE, "a packed layer holds one map layer");
+_Static_assert(sizeof(TileRef) == sizeof(uint16_t), "geometry views read TileRefs straight from the blob");
+_Static_assert(MAP_LAYERS <= 32 && MAP_HEIGHT <= 32, "non-empty layers and rows fit a 32-bit mask");
+
+/**
+ * GeometryMap - Tile layout of one cell
+ * @storage: Where the tiles live; read them through `geometry_get_tile`
+ * @tiles: Tile references indexed [(layer * MAP_HEIGHT + y) * MAP_WIDTH + x],
+ *         pointing into the blob (VIEW) or at a private copy (DENSE); NULL when PACKED
+ * @packed: One palette-packed layer per map layer, when PACKED
+ * @arena: Arena holding the map and everything it allocates, or NULL for the heap
+ * @occupancy: One word per row, bit x set when the tile at (layer, y, x) is not air
+ * @layers: Bit layer set when that layer has any non-air tile
+ * @revision: Changes on load and on every edit, and is never reused by another
+ *            map, so baked meshes can tell when this or a neighbouring map changed
+ *
+ * The masks are kept up to date by `geometry_load` and `geometry_set_tile`, so
+ * traversals can jump between occupied tiles with ctz instead of decoding
+ * every `TileRef`.
+ */
 typedef struct GeometryMap {
-    TileRef tiles[MAP_LAYERS][MAP_HEIGHT][MAP_WIDTH];
+    MapStorage storage;
+    const TileRef* tiles;
+    PackedLayer packed[MAP_LAYERS];
+    Arena* arena;
+    uint32_t occupancy[MAP_LAYERS][MAP_HEIGHT];
+    uint32_t layers;
+    uint32_t revision;
 } GeometryMap;
 
-GeometryMap* geometry_load(uint16_t geometry_id);
+/**
+ * geometry_load - Load the geometry of a cell
+ * @geometry_id: `ASSET_GEOMETRY` id
+ * @arena: Arena for the map, its packed layers and its copy-on-write tiles,
+ *         or NULL to allocate each on the heap
+ *
+ * The tiles are used in place (MAP_STORAGE_VIEW) whenever they are aligned,
+ * so loading only builds the occupancy masks. Version 2, which the shipped data
+ * and packs use (tools/build/convert_assets.py), pads the header to 16 bytes,
+ * which together with the aligned data embedding guarantees that; version 1 has
+ * a 6-byte header and is only aligned when the blob starts on an even address.
+ * Unaligned tiles are palette-packed (MAP_STORAGE_PACKED).
+ */
+GeometryMap* geometry_load(uint16_t geometry_id, Arena* arena);
+
+/**
+ * geometry_parse - Load the geometry of a cell from a blob already in memory
+ * @blob: Geometry blob (may be NULL), e.g. read from disk by the loader
+ * @arena: As for `geometry_load`
+ * @borrow: Whether the map may point into @blob (MAP_STORAGE_VIEW), which must
+ *          then outlive it. Otherwise the tiles are palette-packed into @arena
+ *          and @blob may be freed on return.
+ */
+GeometryMap* geometry_parse(const Blob* blob, Arena* arena, bool borrow);
+
+/**
+ * geometry_free - Free a map loaded onto the heap
+ * @map: Map to free (may be NULL); arena maps are left to `arena_release`
+ */
 void geometry_free(GeometryMap* map);
 
+/**
+ * geometry_set_tile - Replace one tile and bump the map revision
+ * @map: Map to edit
+ * @layer, @y, @x: Tile coordinates; out-of-range coordinates are ignored
+ * @ref: New tile reference
+ *
+ * The first edit gives the map a private dense copy (MAP_STORAGE_DENSE);
+ * the edit is dropped if that copy cannot be allocated.
+ */
+void geometry_set_tile(GeometryMap* map, int layer, int y, int x, TileRef ref);
+
+/**
+ * geometry_get_tile - Tile reference at (@layer, @y, @x)
+ *
+ * Coordinates must be in range.
+ */
+static inline TileRef geometry_get_tile(const GeometryMap* map, int layer, int y, int x)
+{
+    uint32_t index = (uint32_t)(y * MAP_WIDTH + x);
+
+    if (map->tiles)
+        return map->tiles[(uint32_t)layer * PACKED_LAYER_SIZE + index];
+
+    return (TileRef){ packed_layer_get(&map->packed[layer], index) };
+}
+
+/**
+ * geometry_decode_row - Read a whole row of tiles at once
+ * @map: Map to read
+ * @layer, @y: Row coordinates; must be in range
+ * @out: Receives MAP_WIDTH tile references
+ */
+void geometry_decode_row(const GeometryMap* map, int layer, int y, TileRef out[MAP_WIDTH]);
+
+/**
+ * geometry_bytes - Memory held by @map, including the struct itself
+ */
+size_t geometry_bytes(const GeometryMap* map);
+
+/**
+ * geometry_is_occupied - Whether the tile at (@layer, @y, @x) is not air
+ *
+ * Coordinates must be in range.
+ */
+static inline bool geometry_is_occupied(const GeometryMap* map, int layer, int y, int x)
+{
+    return (map->occupancy[layer][y] >> x) & 1u;
+}
+
+/**
+ * geometry_bounds - Tile ranges covered by the non-air tiles of @map
+ * @map: Map to measure
+ * @min, @max: Receive the first and one-past-last tile index along (x, layer, y)
+ *
+ * Returns false, leaving @min and @max untouched, when the map is all air.
+ */
+bool geometry_bounds(const GeometryMap* map, int min[3], int max[3]);
+
 uint8_t tile_get_tileset(TileRef ref);
 uint16_t tile_get_id(TileRef ref);
 
@@ -3,6 +3,9 @@
 
 #include <stdint.h>
 
+/* Entry of `WorldHeaders.index` for header IDs that are not in the blob */
+#define WORLD_HEADER_MISSING 0xFFFF
+
 typedef struct WorldHeader
 {
     uint16_t header_id;
@@ -14,15 +17,41 @@ typedef struct WorldHeader
     uint16_t interior_tileset_id;
 } WorldHeader;
 
+/**
+ * WorldHeaders - All world headers, with a lookup table by ID
+ * @count: Number of entries in @headers
+ * @headers: Headers in blob order
+ * @index: Position in @headers of each header ID, or WORLD_HEADER_MISSING;
+ *         dense over 0 .. @index_count - 1
+ * @index_count: One past the highest header ID
+ *
+ * Header IDs are 16-bit, so even a fully sparse set costs at most 128 KB of
+ * index and a lookup is one bounds check and one load.
+ */
 typedef struct WorldHeaders {
     uint16_t count;
     WorldHeader* headers;
+
+    uint16_t* index;
+    uint32_t index_count;
 } WorldHeaders;
 
 extern WorldHeaders g_WorldHeaders;
 
+/**
+ * world_headers_load - Parse the embedded header blob and build the ID index
+ * @headers: Receives the headers; left empty if the blob is invalid.
+ *
+ * When an ID appears more than once the first header wins.
+ */
 void world_headers_load(WorldHeaders* headers);
 void world_headers_free(WorldHeaders* headers);
+
+/**
+ * world_headers_get - Header with ID @header_id
+ *
+ * Return: NULL when no such header was loaded.
+ */
 const WorldHeader* world_headers_get(const WorldHeaders* headers, uint16_t header_id);
 
 #endif // !WORLD_HEADER_H
\ No newline at end of file
@@ -0,0 +1,126 @@
+#ifndef WORLD_LOADER_H
+#define WORLD_LOADER_H
+
+#include "world/world.h"
+#include "async_io.h"
+#include <stdbool.h>
+
+/* Reads one job can issue: geometry, collision and the three tilesets */
+#define WORLD_LOAD_MAX_READS 5
+
+/* Jobs whose reads may be in flight at once */
+#define WORLD_LOAD_MAX_READING 4
+
+/**
+ * WorldLoadKind - What a `WorldLoadJob` produces
+ * @WORLD_LOAD_CELL: A full-detail `WorldCell`
+ * @WORLD_LOAD_LOD: A `WorldLodCell` of the LOD ring
+ */
+typedef enum WorldLoadKind {
+    WORLD_LOAD_CELL,
+    WORLD_LOAD_LOD,
+} WorldLoadKind;
+
+/**
+ * WorldLoadJob - One cell to load on the loader thread
+ * @kind: Which member of the result union is filled in.
+ * @world_x, @world_y: Coordinates of the cell in world matrix space.
+ * @reads, @batch: Blobs the prepare callback wants read before the job is
+ *                 parsed; @batch.count of them, 0 to parse straight away.
+ * @loaded: Set once the load callback has run.
+ * @cell: Result for WORLD_LOAD_CELL.
+ * @lod: Result for WORLD_LOAD_LOD.
+ * @next: Queue link, owned by the loader.
+ */
+typedef struct WorldLoadJob {
+    WorldLoadKind kind;
+    int world_x;
+    int world_y;
+
+    AsyncRead reads[WORLD_LOAD_MAX_READS];
+    AsyncBatch batch;
+    bool loaded;
+
+    union {
+        WorldCell cell;
+        WorldLodCell lod;
+    };
+
+    struct WorldLoadJob* next;
+} WorldLoadJob;
+
+/**
+ * WorldLoadFunc - Fills in the result of @job; runs on the loader thread
+ */
+typedef void (*WorldLoadFunc)(WorldLoadJob* job);
+
+/**
+ * WorldLoadWanted - Whether a queued cell is still needed
+ * @kind, @world_x, @world_y: The queued cell.
+ * @user: Opaque pointer passed to `world_loader_prune`.
+ */
+typedef bool (*WorldLoadWanted)(WorldLoadKind kind, int world_x, int world_y, void* user);
+
+/**
+ * world_loader_init - Start the background loader thread and the I/O stage
+ * @prepare: Callback that fills in the reads of a job; may be NULL.
+ * @load: Callback that parses one cell once its reads are done; it must
+ *        only touch data that the main thread leaves alone until the job is
+ *        collected.
+ *
+ * A job goes queued -> reading -> ready -> loaded. Up to
+ * WORLD_LOAD_MAX_READING jobs wait on the disk at once while the thread
+ * parses the ones whose data has arrived, so one cell's I/O overlaps with
+ * the others' parsing. Without a thread (creation failed) jobs are read and
+ * loaded inside `world_loader_collect` instead, so callers need no fallback.
+ */
+void world_loader_init(WorldLoadFunc prepare, WorldLoadFunc load);
+
+/**
+ * world_loader_request - Queue a cell for loading
+ * @kind, @world_x, @world_y: Cell to load.
+ *
+ * Jobs start in request order, though a job whose reads finish first is
+ * parsed first. A cell that is already queued, being read or loaded, or
+ * waiting to be collected is not queued twice.
+ *
+ * Return: true if a new job was queued.
+ */
+bool world_loader_request(WorldLoadKind kind, int world_x, int world_y);
+
+/**
+ * world_loader_prune - Drop queued jobs that are no longer needed
+ * @wanted: Predicate deciding which jobs to keep.
+ * @user: Opaque pointer passed to @wanted.
+ *
+ * Only jobs that have not started are dropped; finished ones are still
+ * handed out by `world_loader_collect`.
+ */
+void world_loader_prune(WorldLoadWanted wanted, void* user);
+
+/**
+ * world_loader_collect - Take one finished job, without blocking
+ *
+ * The caller owns the result and returns the job with `world_loader_release`.
+ *
+ * Return: The oldest finished job, or NULL if none is ready.
+ */
+WorldLoadJob* world_loader_collect(void);
+
+/**
+ * world_loader_release - Free a job returned by `world_loader_collect`
+ * @job: Job whose result has been moved out or unloaded.
+ */
+void world_loader_release(WorldLoadJob* job);
+
+/**
+ * world_loader_shutdown - Stop and join the loader thread
+ * @discard: Called for every job that was prepared but never collected, to
+ *           free its read buffers or, if @job->loaded, unload its result.
+ *
+ * Waits for the job in progress and for reads in flight, drops the jobs that
+ * have not started and stops the I/O stage.
+ */
+void world_loader_shutdown(WorldLoadFunc discard);
+
+#endif // !WORLD_LOADER_H
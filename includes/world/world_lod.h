@@ -0,0 +1,55 @@
+#ifndef WORLD_LOD_H
+#define WORLD_LOD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sketch.h"
+#include "world/world_mesh.h"
+
+/* Tile columns per side of one LOD heightmap quad */
+#define LOD_BLOCK   4
+#define LOD_GRID_X  (MAP_WIDTH / LOD_BLOCK)
+#define LOD_GRID_Z  (MAP_HEIGHT / LOD_BLOCK)
+
+/**
+ * LodMesh - Simplified stand-in for a distant cell
+ * @vertices, @vertex_count: Vertices in cell space
+ * @indices, @index_count: Triangle indices into @vertices
+ * @colors: Top-surface colour per tile column, indexed [y][x]; used as the mesh texture
+ * @min, @max: Bounds of @vertices
+ * @arena: Holds @vertices and @indices
+ *
+ * The surface is a heightmap with one quad per LOD_BLOCK x LOD_BLOCK columns,
+ * at the height of the highest tile in the block, plus skirts along the cell
+ * border that hide cracks against neighbouring LOD cells.
+ */
+typedef struct LodMesh {
+    RasterVertex* vertices;
+    uint32_t vertex_count;
+
+    uint32_t* indices;
+    uint32_t index_count;
+
+    uint32_t colors[MAP_HEIGHT][MAP_WIDTH];
+
+    Vec3 min;
+    Vec3 max;
+
+    Arena* arena;
+} LodMesh;
+
+/**
+ * lod_mesh_build - Build the LOD representation of a cell
+ * @mesh: Mesh to fill; any previous contents are freed
+ * @cell: The cell; only needed during the call
+ *
+ * Returns false (leaving @mesh empty) if the cell has no geometry or memory ran out.
+ */
+bool lod_mesh_build(LodMesh* mesh, const ChunkSource* cell);
+
+/**
+ * lod_mesh_free - Release the mesh arrays and reset @mesh to empty
+ */
+void lod_mesh_free(LodMesh* mesh);
+
+#endif // !WORLD_LOD_H
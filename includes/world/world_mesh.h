@@ -0,0 +1,227 @@
+#ifndef WORLD_MESH_H
+#define WORLD_MESH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sketch.h"
+#include "world/world_geometry.h"
+#include "world/world_tileset.h"
+#include "lighting/directional_light.h"
+#include "camera.h"
+
+/* A triangle is left out of the face list for a direction when its normal is
+ * within this many degrees of the direction: from any camera whose view stays
+ * inside CHUNK_VIEW_CONE_DEGREES of the horizontal forward vector (pitch plus
+ * the frustum's corner angle), it can only ever be seen from behind.
+ */
+#define CHUNK_VIEW_CONE_DEGREES 60.0f
+
+/* `ChunkBrick.facing_count` of a face list whose triangles have to be culled one by one */
+#define CHUNK_FACING_MIXED UINT16_MAX
+
+/* Distance the eye must keep in front of a `ChunkFacing` plane to skip the
+ * winding test, in tiles; covers the rounding of normals and vertices
+ */
+#define CHUNK_FACING_EPSILON 0.001f
+
+/* Least cosine between a triangle's winding normal and its stored normal for
+ * the triangle to be bounded by a `ChunkFacing` plane
+ */
+#define CHUNK_FACING_AGREEMENT 0.99999f
+
+/**
+ * ChunkSide - Horizontal neighbours of a cell
+ * @CHUNK_SIDE_WEST, @CHUNK_SIDE_EAST: Cells at map x - 1 and x + 1
+ * @CHUNK_SIDE_NORTH, @CHUNK_SIDE_SOUTH: Cells at map y - 1 and y + 1
+ */
+typedef enum ChunkSide {
+    CHUNK_SIDE_WEST,
+    CHUNK_SIDE_EAST,
+    CHUNK_SIDE_NORTH,
+    CHUNK_SIDE_SOUTH,
+    CHUNK_SIDE_COUNT
+} ChunkSide;
+
+/**
+ * ChunkSource - Everything needed to look up the tiles of one cell
+ * @geo: Cell geometry (may be NULL)
+ * @regional, @local, @interior: Tilesets referenced by @geo (may be NULL)
+ * @vertical_offset: Cell's vertical offset, used to line up layers across borders
+ */
+typedef struct ChunkSource {
+    const GeometryMap* geo;
+    const Tileset* regional;
+    const Tileset* local;
+    const Tileset* interior;
+    int16_t vertical_offset;
+} ChunkSource;
+
+/* Cells are split into cubic bricks for frustum culling */
+#define CHUNK_BRICK_SIZE    8
+#define CHUNK_BRICKS_X      (MAP_WIDTH / CHUNK_BRICK_SIZE)
+#define CHUNK_BRICKS_Y      (MAP_LAYERS / CHUNK_BRICK_SIZE)
+#define CHUNK_BRICKS_Z      (MAP_HEIGHT / CHUNK_BRICK_SIZE)
+#define CHUNK_BRICK_COUNT   (CHUNK_BRICKS_X * CHUNK_BRICKS_Y * CHUNK_BRICKS_Z)
+
+/* Brick index of brick coordinates along (x, layer, map y) */
+#define CHUNK_BRICK_INDEX(bx, by, bz) (((by) * CHUNK_BRICKS_Z + (bz)) * CHUNK_BRICKS_X + (bx))
+
+/**
+ * ChunkBrick - The part of a `ChunkMesh` built from one brick of tiles
+ * @min, @max: Bounds of the brick's vertices in cell space
+ * @vertex_first, @vertex_count: Range of the brick's vertices; its indices are relative to @vertex_first
+ * @face_first, @face_count: Range of the brick's triangles in the build-order arrays
+ * @view_first, @view_count: Range of the brick's triangles in each `ChunkMesh.views` list
+ * @facing_first, @facing_count: Range of the brick's planes in each list's
+ *                               `ChunkFaces.facing`, or CHUNK_FACING_MIXED
+ *
+ * Triangles never span two bricks (greedy merging stops at brick borders), so
+ * each brick can be drawn, or skipped, on its own.
+ */
+typedef struct ChunkBrick {
+    Vec3 min;
+    Vec3 max;
+
+    uint32_t vertex_first;
+    uint32_t vertex_count;
+
+    uint32_t face_first;
+    uint32_t face_count;
+
+    uint32_t view_first[CAMERA_CARDINAL_COUNT];
+    uint32_t view_count[CAMERA_CARDINAL_COUNT];
+
+    uint32_t facing_first[CAMERA_CARDINAL_COUNT];
+    uint16_t facing_count[CAMERA_CARDINAL_COUNT];
+} ChunkBrick;
+
+/**
+ * ChunkFacing - Bound on the triangles of a brick's face list that share a normal
+ * @height: Largest dot(normal, vertex) over their vertices
+ * @normal: Index into `ChunkMesh.normals`
+ *
+ * The triangles all face an eye at @e when dot(normal, @e) > @height for
+ * every plane of the brick, since each lies at or below its plane's height.
+ */
+typedef struct ChunkFacing {
+    float height;
+    uint16_t normal;
+} ChunkFacing;
+
+/**
+ * ChunkFaces - A list of triangles of a `ChunkMesh`
+ * @indices, @index_count: Triangle indices, relative to the owning brick's first vertex
+ * @face_textures: Index into the mesh textures per triangle
+ * @face_normals: Index into the mesh normals / normal light per triangle
+ * @facing, @facing_count: Per-brick plane bounds, ranged by `ChunkBrick.facing_first`
+ */
+typedef struct ChunkFaces {
+    uint32_t* indices;
+    uint32_t index_count;
+    uint16_t* face_textures;
+    uint16_t* face_normals;
+    ChunkFacing* facing;
+    uint32_t facing_count;
+} ChunkFaces;
+
+/**
+ * ChunkMesh - All visible tile geometry of one cell baked into a single mesh
+ * @vertices, @vertex_count: Vertices in cell space (tile offsets already applied), grouped by brick
+ * @indices, @index_count: Triangle indices in build order, grouped by brick and
+ *                         relative to the brick's first vertex
+ * @face_textures: Index into @textures per triangle
+ * @face_normals: Index into @normals / @normal_light per triangle
+ * @views: Per `CameraCardinal` face lists without the triangles that can never
+ *         face the camera, grouped by brick and sorted nearest-first within each;
+ *         with their plane bounds, they replace per-triangle back-face culling
+ * @bricks: Per-brick ranges and bounds, indexed by `CHUNK_BRICK_INDEX`
+ * @textures, @texture_count: Distinct tile textures used by the cell
+ * @normals, @normal_light, @normal_count: Distinct face normals and their light factors
+ * @lit_by, @lit: Light that @normal_light was computed for
+ * @revision: `GeometryMap.revision` the mesh was built from
+ * @neighbour_revisions: Revisions of the neighbouring maps used for hidden-face removal (0 = none)
+ * @built: false until the first successful `chunk_mesh_build`
+ * @arena: Holds the vertex, index and face arrays; the palettes grow while
+ *         building and live on the heap
+ */
+typedef struct ChunkMesh {
+    RasterVertex* vertices;
+    uint32_t vertex_count;
+
+    uint32_t* indices;
+    uint32_t index_count;
+
+    uint16_t* face_textures;
+    uint16_t* face_normals;
+
+    ChunkFaces views[CAMERA_CARDINAL_COUNT];
+    ChunkBrick bricks[CHUNK_BRICK_COUNT];
+
+    RasterTexture* textures;
+    uint16_t texture_count;
+
+    Vec3* normals;
+    float* normal_light;
+    uint16_t normal_count;
+
+    DirectionalLight lit_by;
+    bool lit;
+
+    uint32_t revision;
+    uint32_t neighbour_revisions[CHUNK_SIDE_COUNT];
+    bool built;
+
+    Arena* arena;
+} ChunkMesh;
+
+/**
+ * chunk_source_tile - Mesh of the tile at (@layer, @y, @x) of @source
+ *
+ * Returns NULL for air, coordinates outside the cell, tiles missing from their
+ * tileset and tiles without geometry or texture.
+ */
+const TileMesh* chunk_source_tile(const ChunkSource* source, int layer, int y, int x);
+
+/**
+ * chunk_mesh_build - (Re)bake the mesh of a cell
+ * @mesh: Mesh to fill; any previous contents are freed
+ * @cell: The cell to bake
+ * @neighbours: Adjacent cells indexed by `ChunkSide`; NULL entries count as air
+ *
+ * Air tiles, tiles missing from their tileset and tiles without a texture are
+ * left out, as is every triangle lying on a tile face that the neighbouring
+ * tile (possibly in a neighbouring cell) covers with a full face.
+ * The four per-direction face lists are built as well, so turning the camera
+ * never needs a rebuild.
+ * Returns false (leaving @mesh empty) if memory ran out.
+ */
+bool chunk_mesh_build(
+    ChunkMesh* mesh,
+    const ChunkSource* cell,
+    const ChunkSource* const neighbours[CHUNK_SIDE_COUNT]
+);
+
+/**
+ * chunk_mesh_is_stale - Whether @mesh must be rebuilt because @cell or one of its neighbours changed
+ */
+bool chunk_mesh_is_stale(
+    const ChunkMesh* mesh,
+    const ChunkSource* cell,
+    const ChunkSource* const neighbours[CHUNK_SIDE_COUNT]
+);
+
+/**
+ * chunk_mesh_update_lighting - Refresh the light factor of every distinct normal
+ * @mesh: Mesh to light
+ * @light: Light to evaluate
+ *
+ * Does nothing when @light is unchanged since the last call.
+ */
+void chunk_mesh_update_lighting(ChunkMesh* mesh, const DirectionalLight* light);
+
+/**
+ * chunk_mesh_free - Release the mesh arrays and reset @mesh to empty
+ */
+void chunk_mesh_free(ChunkMesh* mesh);
+
+#endif // !WORLD_MESH_H
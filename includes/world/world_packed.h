@@ -0,0 +1,91 @@
+#ifndef WORLD_PACKED_H
+#define WORLD_PACKED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "arena.h"
+
+/* Values per packed layer (one MAP_HEIGHT x MAP_WIDTH slice of a map) */
+#define PACKED_LAYER_SIZE 1024
+
+/**
+ * MapStorage - Where the tiles of a `GeometryMap` or `CollisionMap` live
+ * @MAP_STORAGE_VIEW: Read-only, directly in the embedded blob; costs no memory
+ * @MAP_STORAGE_DENSE: Private array, made on the first edit (copy-on-write)
+ * @MAP_STORAGE_PACKED: Palette-packed layers, for blobs that cannot be viewed
+ *                      in place (older formats or misaligned data)
+ */
+typedef enum MapStorage {
+    MAP_STORAGE_VIEW,
+    MAP_STORAGE_DENSE,
+    MAP_STORAGE_PACKED,
+} MapStorage;
+
+/**
+ * PackedLayer - One layer of a map as indices into a palette of its distinct values
+ * @words: Indices of @bits each, packed low to high into 32-bit words; NULL when @bits is 0
+ * @palette: The distinct values, sorted; unused when @bits is 0 or 16
+ * @fill: The only value of the layer, when @bits is 0
+ * @palette_count: Number of entries in @palette
+ * @bits: Index width: 0 (uniform layer, nothing allocated), 1, 2, 4 or 8; 16
+ *        stores the values themselves when a palette would not be smaller
+ *
+ * Widths divide 32, so an index never straddles two words and random access
+ * is a shift and a mask. Most layers are air or a handful of tile types, so a
+ * layer usually costs 0-256 bytes instead of 2 KB.
+ */
+typedef struct PackedLayer {
+    uint32_t* words;
+    uint16_t* palette;
+    uint16_t fill;
+    uint16_t palette_count;
+    uint8_t bits;
+} PackedLayer;
+
+/**
+ * packed_layer_build - Pack PACKED_LAYER_SIZE values
+ * @layer: Receives the packed layer.
+ * @values: Values in row-major order.
+ * @arena: Arena to allocate from, or NULL for the heap.
+ *
+ * Return: false if out of memory, leaving @layer empty.
+ */
+bool packed_layer_build(PackedLayer* layer, const uint16_t values[PACKED_LAYER_SIZE], Arena* arena);
+
+/**
+ * packed_layer_free - Release the memory of a packed layer
+ * @layer: Layer to free; left as an empty uniform layer.
+ * @arena: Arena the layer was built in, or NULL for the heap.
+ */
+void packed_layer_free(PackedLayer* layer, Arena* arena);
+
+/**
+ * packed_layer_decode - Unpack a run of values
+ * @layer: Layer to read.
+ * @first: Index of the first value.
+ * @count: Number of values; @first + @count must not exceed PACKED_LAYER_SIZE.
+ * @out: Receives @count values.
+ */
+void packed_layer_decode(const PackedLayer* layer, uint32_t first, uint32_t count, uint16_t* out);
+
+/**
+ * packed_layer_bytes - Heap memory used by a packed layer
+ */
+size_t packed_layer_bytes(const PackedLayer* layer);
+
+/**
+ * packed_layer_get - Value at row-major @index of a packed layer
+ */
+static inline uint16_t packed_layer_get(const PackedLayer* layer, uint32_t index)
+{
+    if (layer->bits == 0)
+        return layer->fill;
+
+    uint32_t bit = index * layer->bits;
+    uint32_t value = (layer->words[bit >> 5] >> (bit & 31)) & ((1u << layer->bits) - 1);
+
+    return layer->bits == 16 ? (uint16_t)value : layer->palette[value];
+}
+
+#endif // !WORLD_PACKED_H
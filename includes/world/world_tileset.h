@@ -1,26 +1,122 @@
 #ifndef WORLD_TILESET_H
 #define WORLD_TILESET_H
 
+#include "lighting/directional_light.h"
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 
 typedef struct Vertex {
     float x, y, z;
     float u, v;
 } Vertex;
 
+/**
+ * TileFace - The six unit faces of a tile's cell
+ *
+ * Tiles span x in [0, 1], y in [0, 1] and z in [-1, 0] before being placed at
+ * (x, layer, y), so +X/-X step the map x, +Y/-Y the layer and +Z/-Z the map y.
+ */
+typedef enum TileFace {
+    TILE_FACE_NEG_X,
+    TILE_FACE_POS_X,
+    TILE_FACE_NEG_Y,
+    TILE_FACE_POS_Y,
+    TILE_FACE_NEG_Z,
+    TILE_FACE_POS_Z,
+    TILE_FACE_COUNT,
+
+    TILE_FACE_NONE = 0xFF
+} TileFace;
+
+#define TILE_FACE_BIT(face)     (1u << (face))
+#define TILE_FACE_OPPOSITE(face) ((TileFace)((face) ^ 1))
+
+#define TILE_QUADS_MAX  16
+#define TILE_QUAD_NONE  0xFF
+
+/**
+ * TileQuad - Triangles of a tile that exactly tile one axis-aligned unit square
+ * @axis: Plane normal axis (0 = x, 1 = y, 2 = z)
+ * @normal_sign: Direction of the front face along @axis (+1 or -1)
+ * @offset: Plane position along @axis, measured from the tile's minimum corner
+ * @uv: Texture mapping over the square: u = uv[0][0] * s + uv[0][1] * t + uv[0][2],
+ *      and likewise for v from uv[1], where (s, t) in [0, 1] are the in-plane
+ *      coordinates from the minimum corner (s, t = z, y for x planes, x, z for
+ *      y planes, x, y for z planes)
+ * @face: One triangle of the quad, for its normal
+ *
+ * Greedy meshing merges equal quads of neighbouring tiles into larger ones
+ * with repeating UVs, which reproduces the per-tile texture mapping exactly.
+ */
+typedef struct TileQuad {
+    uint8_t axis;
+    int8_t normal_sign;
+    float offset;
+    int8_t uv[2][3];
+    uint32_t face;
+} TileQuad;
+
+/* Minimum corner of a tile along @axis (0 = x, 1 = y, 2 = z) */
+static inline float tile_min_corner(int axis)
+{
+    return axis == 2 ? -1.0f : 0.0f;
+}
+
+/* In-plane axes (s, t) of a quad lying on a plane normal to @axis */
+static inline int tile_plane_s_axis(int axis)
+{
+    return axis == 0 ? 2 : 0;
+}
+
+static inline int tile_plane_t_axis(int axis)
+{
+    return axis == 1 ? 2 : 1;
+}
+
+/**
+ * TileMesh - Static mesh of one tile
+ * @vertices, @indices, @pixels: Geometry and RGBA32 texture; for version 4
+ *                               tilesets these point straight into the embedded blob
+ * @normals: Unit normal per triangle (index_count / 3 entries); zero for degenerate faces
+ * @face_planes: Per triangle, the `TileFace` it lies on and faces out of, or TILE_FACE_NONE
+ * @full_faces: `TILE_FACE_BIT` mask of faces completely covered by opaque triangles
+ * @quads, @quad_count: Unit squares of the tile available for greedy meshing
+ * @face_quads: Per triangle, the index into @quads it belongs to, or TILE_QUAD_NONE
+ * @average_color: Mean colour of the texture's visible pixels, for distant LOD (0 if none)
+ */
 typedef struct TileMesh {
-    Vertex* vertices;
+    const Vertex* vertices;
     uint32_t vertex_count;
-    uint16_t* indices;
+    const uint16_t* indices;
     uint32_t index_count;
-    uint32_t* pixels;
+    const uint32_t* pixels;
     uint16_t texture_width;
     uint16_t texture_height;
+    const Vec3* normals;
+    const uint8_t* face_planes;
+    uint8_t full_faces;
+    TileQuad quads[TILE_QUADS_MAX];
+    uint8_t quad_count;
+    const uint8_t* face_quads;
+    uint32_t average_color;
 } TileMesh;
 
+/**
+ * Tileset - All tiles of one embedded tileset
+ * @tiles, @tile_count: The tiles, indexed by `tile_get_id`
+ * @borrowed: Tile arrays point into the embedded blob (version 4) instead of
+ *            being owned copies; only @storage is freed with the tileset
+ * @storage: Derived per-triangle data of every tile in one block, when @borrowed
+ * @blob: Heap copy of the blob @borrowed tiles point into, when it was read
+ *        from disk rather than mapped; freed with the tileset
+ */
 typedef struct Tileset {
     TileMesh* tiles;
     uint16_t tile_count;
+    bool borrowed;
+    uint8_t* storage;
+    uint8_t* blob;
 } Tileset;
 
 Tileset* tileset_load_regional(uint16_t tileset_id);
@@ -28,4 +124,64 @@ Tileset* tileset_load_local(uint16_t tileset_id);
 Tileset* tileset_load_interior(uint16_t tileset_id);
 void tileset_free(Tileset* tileset);
 
+/**
+ * TilesetKind - Which embedded tileset table an id refers to
+ */
+typedef enum TilesetKind {
+    TILESET_REGIONAL,
+    TILESET_LOCAL,
+    TILESET_INTERIOR,
+    TILESET_KIND_COUNT,
+} TilesetKind;
+
+/**
+ * tileset_cache_init - Prepare the shared tileset cache
+ *
+ * Must be called before `tileset_acquire` is used from more than one thread.
+ */
+void tileset_cache_init(void);
+
+/**
+ * tileset_cache_free - Free every cached tileset and the cache itself
+ *
+ * Tilesets still acquired at this point are freed too.
+ */
+void tileset_cache_free(void);
+
+/**
+ * tileset_acquire - Get a shared, read-only tileset
+ * @kind: Table the id belongs to.
+ * @tileset_id: Index into that table.
+ *
+ * Each (@kind, @tileset_id) is parsed once and shared by every caller until
+ * the last one releases it. Safe to call from any thread.
+ *
+ * Return: The tileset, or NULL if the id is out of range or parsing failed.
+ */
+Tileset* tileset_acquire(TilesetKind kind, uint16_t tileset_id);
+
+/**
+ * tileset_acquire_data - Like `tileset_acquire`, parsing a blob already read into memory
+ * @kind, @tileset_id: Key of the tileset.
+ * @data: malloc'd copy of the blob; always taken over, and freed unless the
+ *        parsed tileset points into it.
+ * @size: Size of @data.
+ *
+ * @data is only parsed if the tileset is not cached yet.
+ */
+Tileset* tileset_acquire_data(TilesetKind kind, uint16_t tileset_id, uint8_t* data, size_t size);
+
+/**
+ * tileset_is_cached - Whether (@kind, @tileset_id) is parsed and shared right now
+ *
+ * Lets the loader skip reading a tileset that `tileset_acquire` would not parse.
+ */
+bool tileset_is_cached(TilesetKind kind, uint16_t tileset_id);
+
+/**
+ * tileset_release - Drop a reference taken with `tileset_acquire`
+ * @tileset: Tileset to release (may be NULL); freed with the last reference.
+ */
+void tileset_release(Tileset* tileset);
+
 #endif // !WORLD_TILESET_H
\ No newline at end of file
@@ -0,0 +1,211 @@
+/*
+ * arena.c - Pooled bump allocators
+ *
+ * An arena is a chain of blocks. Allocation bumps an offset in the current
+ * block and moves on to the next block (reusing it, or inserting a new one)
+ * when it does not fit. Releasing an arena only rewinds it to its first block
+ * and pushes it onto the pool's free list; the chain is kept for reuse.
+ */
+
+#include "arena.h"
+#include "thread.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct ArenaBlock
+{
+	struct ArenaBlock* next;
+	size_t size;
+	size_t used;
+	_Alignas(ARENA_ALIGN) unsigned char data[];
+} ArenaBlock;
+
+struct Arena
+{
+	ArenaBlock* first;
+	ArenaBlock* current;
+	size_t used;
+	Arena* next_free;
+};
+
+static struct
+{
+	Mutex* mutex;
+	Arena* free_list;
+} pool;
+
+static ArenaBlock* arena_block_create(size_t size)
+{
+	ArenaBlock* block = malloc(sizeof(ArenaBlock) + size);
+	if (!block) return NULL;
+
+	block->next = NULL;
+	block->size = size;
+	block->used = 0;
+	return block;
+}
+
+static Arena* arena_create(void)
+{
+	Arena* arena = malloc(sizeof(Arena));
+	if (!arena) return NULL;
+
+	arena->first = arena_block_create(ARENA_BLOCK_SIZE);
+	if (!arena->first)
+	{
+		free(arena);
+		return NULL;
+	}
+
+	arena->current = arena->first;
+	arena->used = 0;
+	arena->next_free = NULL;
+	return arena;
+}
+
+static void arena_destroy(Arena* arena)
+{
+	ArenaBlock* block = arena->first;
+	while (block)
+	{
+		ArenaBlock* next = block->next;
+		free(block);
+		block = next;
+	}
+
+	free(arena);
+}
+
+void arena_pool_init(int arena_count)
+{
+	if (!pool.mutex)
+		pool.mutex = mutex_create();
+
+	for (int i = 0; i < arena_count; i++)
+	{
+		Arena* arena = arena_create();
+		if (!arena) break;
+
+		arena->next_free = pool.free_list;
+		pool.free_list = arena;
+	}
+}
+
+void arena_pool_free(void)
+{
+	while (pool.free_list)
+	{
+		Arena* next = pool.free_list->next_free;
+		arena_destroy(pool.free_list);
+		pool.free_list = next;
+	}
+
+	mutex_destroy(pool.mutex);
+	pool.mutex = NULL;
+}
+
+Arena* arena_acquire(void)
+{
+	Arena* arena = NULL;
+
+	if (pool.mutex)
+	{
+		mutex_lock(pool.mutex);
+		arena = pool.free_list;
+		if (arena)
+			pool.free_list = arena->next_free;
+		mutex_unlock(pool.mutex);
+	}
+
+	if (!arena)
+		arena = arena_create();
+
+	if (arena)
+		arena->next_free = NULL;
+
+	return arena;
+}
+
+void arena_release(Arena* arena)
+{
+	if (!arena) return;
+
+	// Later blocks are reset as the next owner reaches them
+	arena->current = arena->first;
+	arena->first->used = 0;
+	arena->used = 0;
+
+	if (!pool.mutex)
+	{
+		arena_destroy(arena);
+		return;
+	}
+
+	mutex_lock(pool.mutex);
+	arena->next_free = pool.free_list;
+	pool.free_list = arena;
+	mutex_unlock(pool.mutex);
+}
+
+void* arena_alloc(Arena* arena, size_t size)
+{
+	if (!arena)
+		return malloc(size);
+
+	size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+	ArenaBlock* block = arena->current;
+	while (block->used + size > block->size)
+	{
+		ArenaBlock* next = block->next;
+
+		if (next && size <= next->size)
+		{
+			next->used = 0;
+		}
+		else
+		{
+			// Insert a block big enough; anything after it stays for later
+			ArenaBlock* fresh = arena_block_create(size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE);
+			if (!fresh) return NULL;
+
+			fresh->next = next;
+			block->next = fresh;
+			next = fresh;
+		}
+
+		block = next;
+	}
+
+	void* ptr = block->data + block->used;
+	block->used += size;
+	arena->current = block;
+	arena->used += size;
+	return ptr;
+}
+
+void* arena_calloc(Arena* arena, size_t count, size_t size)
+{
+	if (!arena)
+		return calloc(count, size);
+
+	if (size && count > SIZE_MAX / size)
+		return NULL;
+
+	void* ptr = arena_alloc(arena, count * size);
+	if (ptr)
+		memset(ptr, 0, count * size);
+	return ptr;
+}
+
+void arena_free(Arena* arena, void* ptr)
+{
+	if (!arena)
+		free(ptr);
+}
+
+size_t arena_used(const Arena* arena)
+{
+	return arena ? arena->used : 0;
+}
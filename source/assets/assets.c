@@ -0,0 +1,310 @@
+/*
+ * assets.c - World data lookup
+ *
+ * Blobs come from a memory-mapped .gbpak when one is open, and otherwise from
+ * the tables generated for the data linked into the executable. Opening a
+ * pack reads only its header and table of contents; each entry's checksum is
+ * verified the first time it is looked up, so startup does not page in data
+ * for cells that are never visited.
+ */
+
+#include "assets.h"
+#include "async_io.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef GB_ASSET_PACK
+#include "generated/Geometry.h"
+#include "generated/Collision.h"
+#include "generated/Tileset_Regional.h"
+#include "generated/Tileset_Local.h"
+#include "generated/Tileset_Interior.h"
+
+extern const uint8_t _binary_data_world_matrix_mtx_start[] __asm__("_binary_data_world_matrix_mtx_start");
+extern const uint8_t _binary_data_world_matrix_mtx_end[] __asm__("_binary_data_world_matrix_mtx_end");
+extern const uint8_t _binary_data_world_headers_hdr_start[] __asm__("_binary_data_world_headers_hdr_start");
+extern const uint8_t _binary_data_world_headers_hdr_end[] __asm__("_binary_data_world_headers_hdr_end");
+#endif
+
+enum
+{
+	SLOT_UNCHECKED,
+	SLOT_VALID,
+	SLOT_CORRUPT,	// also ids missing from the pack
+};
+
+typedef struct AssetSlot
+{
+	Blob blob;
+	uint32_t checksum;
+	atomic_uchar state;
+} AssetSlot;
+
+static struct
+{
+	const uint8_t* data;
+	size_t size;
+	AsyncFile* file;	// same file, for reads that should not fault on the mapping
+
+	AssetSlot* slots[ASSET_KIND_COUNT];
+	size_t counts[ASSET_KIND_COUNT];
+} pack;
+
+static uint32_t crc_table[256];
+
+static void asset_crc32_init(void)
+{
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		uint32_t c = i;
+		for (int k = 0; k < 8; k++)
+			c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+		crc_table[i] = c;
+	}
+}
+
+static uint32_t asset_crc32(const uint8_t* data, size_t size)
+{
+	uint32_t c = 0xFFFFFFFFu;
+	for (size_t i = 0; i < size; i++)
+		c = crc_table[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+	return c ^ 0xFFFFFFFFu;
+}
+
+/* Check the table of contents and build the per-kind slot arrays */
+static bool pack_index(const AssetPackHeader* header)
+{
+	const uint8_t* toc = pack.data + header->toc_offset;
+	AssetPackEntry previous = { 0 };
+
+	for (uint32_t i = 0; i < header->entry_count; i++)
+	{
+		AssetPackEntry entry;
+		memcpy(&entry, toc + i * sizeof(entry), sizeof(entry));
+
+		// Sorted by (kind, id) without duplicates
+		bool ordered = i == 0 || entry.kind > previous.kind ||
+			(entry.kind == previous.kind && entry.id > previous.id);
+
+		if (entry.kind >= ASSET_KIND_COUNT || !ordered ||
+			entry.offset % header->align != 0 ||
+			entry.offset < sizeof(AssetPackHeader) ||
+			entry.offset > header->toc_offset ||
+			entry.size > header->toc_offset - entry.offset)
+			return false;
+
+		pack.counts[entry.kind] = (size_t)entry.id + 1;
+		previous = entry;
+	}
+
+	for (int kind = 0; kind < ASSET_KIND_COUNT; kind++)
+	{
+		if (pack.counts[kind] == 0)
+			continue;
+
+		pack.slots[kind] = calloc(pack.counts[kind], sizeof(AssetSlot));
+		if (!pack.slots[kind])
+			return false;
+
+		for (size_t id = 0; id < pack.counts[kind]; id++)
+			atomic_init(&pack.slots[kind][id].state, SLOT_CORRUPT);
+	}
+
+	for (uint32_t i = 0; i < header->entry_count; i++)
+	{
+		AssetPackEntry entry;
+		memcpy(&entry, toc + i * sizeof(entry), sizeof(entry));
+
+		AssetSlot* slot = &pack.slots[entry.kind][entry.id];
+		slot->blob = (Blob){ pack.data + entry.offset, (size_t)entry.size };
+		slot->checksum = entry.checksum;
+		atomic_init(&slot->state, SLOT_UNCHECKED);
+	}
+
+	return true;
+}
+
+bool assets_open(const char* path)
+{
+	assets_close();
+	asset_crc32_init();
+
+	pack.data = assets_map_file(path, &pack.size);
+	if (!pack.data)
+		return false;
+
+	AssetPackHeader header;
+	if (pack.size < sizeof(header))
+	{
+		assets_close();
+		return false;
+	}
+	memcpy(&header, pack.data, sizeof(header));
+
+	bool valid = header.magic == ASSET_PACK_MAGIC &&
+		header.version == ASSET_PACK_VERSION &&
+		header.align != 0 && header.align % ASSET_PACK_ALIGN == 0 &&
+		header.file_size == pack.size &&
+		header.toc_offset <= pack.size &&
+		header.entry_count <= (pack.size - header.toc_offset) / sizeof(AssetPackEntry);
+
+	if (!valid ||
+		asset_crc32(pack.data + header.toc_offset, header.entry_count * sizeof(AssetPackEntry)) != header.toc_checksum ||
+		!pack_index(&header))
+	{
+		assets_close();
+		return false;
+	}
+
+	// Optional: without it every lookup goes through the mapping
+	pack.file = async_file_open(path);
+
+	return true;
+}
+
+void assets_close(void)
+{
+	for (int kind = 0; kind < ASSET_KIND_COUNT; kind++)
+	{
+		free(pack.slots[kind]);
+		pack.slots[kind] = NULL;
+		pack.counts[kind] = 0;
+	}
+
+	if (pack.data)
+		assets_unmap_file(pack.data, pack.size);
+
+	async_file_close(pack.file);
+	pack.file = NULL;
+
+	pack.data = NULL;
+	pack.size = 0;
+}
+
+#ifndef GB_ASSET_PACK
+static const Blob* embedded_get(AssetKind kind, uint16_t id)
+{
+	// The matrix and headers have no generated table; their sizes are only known at link time
+	static _Thread_local Blob world_blobs[2];
+
+	switch (kind)
+	{
+	case ASSET_GEOMETRY:
+		return id < g_Geometry_Count ? &g_Geometry[id] : NULL;
+	case ASSET_COLLISION:
+		return id < g_Collision_Count ? &g_Collision[id] : NULL;
+	case ASSET_TILESET_REGIONAL:
+		return id < g_Tileset_Regional_Count ? &g_Tileset_Regional[id] : NULL;
+	case ASSET_TILESET_LOCAL:
+		return id < g_Tileset_Local_Count ? &g_Tileset_Local[id] : NULL;
+	case ASSET_TILESET_INTERIOR:
+		return id < g_Tileset_Interior_Count ? &g_Tileset_Interior[id] : NULL;
+	case ASSET_WORLD_MATRIX:
+		if (id != 0) return NULL;
+		world_blobs[0] = (Blob){ _binary_data_world_matrix_mtx_start,
+			(size_t)(_binary_data_world_matrix_mtx_end - _binary_data_world_matrix_mtx_start) };
+		return &world_blobs[0];
+	case ASSET_WORLD_HEADERS:
+		if (id != 0) return NULL;
+		world_blobs[1] = (Blob){ _binary_data_world_headers_hdr_start,
+			(size_t)(_binary_data_world_headers_hdr_end - _binary_data_world_headers_hdr_start) };
+		return &world_blobs[1];
+	default:
+		return NULL;
+	}
+}
+#endif
+
+const Blob* asset_get(AssetKind kind, uint16_t id)
+{
+	if ((unsigned)kind >= ASSET_KIND_COUNT)
+		return NULL;
+
+	if (!pack.data)
+	{
+#ifndef GB_ASSET_PACK
+		return embedded_get(kind, id);
+#else
+		return NULL;
+#endif
+	}
+
+	if (id >= pack.counts[kind])
+		return NULL;
+
+	AssetSlot* slot = &pack.slots[kind][id];
+	unsigned char state = atomic_load_explicit(&slot->state, memory_order_acquire);
+
+	// Two threads may verify the same entry at once; both reach the same verdict
+	if (state == SLOT_UNCHECKED)
+	{
+		state = asset_crc32(slot->blob.data, slot->blob.size) == slot->checksum ? SLOT_VALID : SLOT_CORRUPT;
+		atomic_store_explicit(&slot->state, state, memory_order_release);
+	}
+
+	return state == SLOT_VALID ? &slot->blob : NULL;
+}
+
+/* Slot of a pack entry that exists, or NULL */
+static AssetSlot* pack_slot(AssetKind kind, uint16_t id)
+{
+	if (!pack.data || (unsigned)kind >= ASSET_KIND_COUNT || id >= pack.counts[kind])
+		return NULL;
+
+	AssetSlot* slot = &pack.slots[kind][id];
+	return slot->blob.data ? slot : NULL;
+}
+
+bool asset_locate(AssetKind kind, uint16_t id, AssetLocation* location)
+{
+	AssetSlot* slot = pack_slot(kind, id);
+	if (!slot || !pack.file)
+		return false;
+
+	location->file = pack.file;
+	location->offset = (uint64_t)(slot->blob.data - pack.data);
+	location->size = slot->blob.size;
+	return true;
+}
+
+bool asset_verify(AssetKind kind, uint16_t id, const uint8_t* data, size_t size)
+{
+	AssetSlot* slot = pack_slot(kind, id);
+	if (!slot || size != slot->blob.size)
+		return false;
+
+	unsigned char state = atomic_load_explicit(&slot->state, memory_order_acquire);
+	if (state != SLOT_UNCHECKED)
+		return state == SLOT_VALID;
+
+	// A copy that matches also vouches for the mapped entry
+	if (asset_crc32(data, size) != slot->checksum)
+		return false;
+
+	atomic_store_explicit(&slot->state, SLOT_VALID, memory_order_release);
+	return true;
+}
+
+size_t asset_count(AssetKind kind)
+{
+	if ((unsigned)kind >= ASSET_KIND_COUNT)
+		return 0;
+
+	if (pack.data)
+		return pack.counts[kind];
+
+#ifndef GB_ASSET_PACK
+	switch (kind)
+	{
+	case ASSET_GEOMETRY:			return g_Geometry_Count;
+	case ASSET_COLLISION:			return g_Collision_Count;
+	case ASSET_TILESET_REGIONAL:	return g_Tileset_Regional_Count;
+	case ASSET_TILESET_LOCAL:		return g_Tileset_Local_Count;
+	case ASSET_TILESET_INTERIOR:	return g_Tileset_Interior_Count;
+	default:						return 1;
+	}
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,42 @@
+#ifdef __linux__
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "assets.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const uint8_t* assets_map_file(const char* path, size_t* size)
+{
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return NULL;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size <= 0)
+	{
+		close(fd);
+		return NULL;
+	}
+
+	// The mapping keeps the file alive; pages are read in on first touch
+	void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (data == MAP_FAILED)
+		return NULL;
+
+	*size = (size_t)info.st_size;
+	return data;
+}
+
+void assets_unmap_file(const uint8_t* data, size_t size)
+{
+	if (data)
+		munmap((void*)data, size);
+}
+
+#endif // __linux__
@@ -0,0 +1,42 @@
+#ifdef _WIN32
+
+#include "assets.h"
+#include <windows.h>
+
+const uint8_t* assets_map_file(const char* path, size_t* size)
+{
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (file == INVALID_HANDLE_VALUE) return NULL;
+
+	LARGE_INTEGER length;
+	if (!GetFileSizeEx(file, &length) || length.QuadPart <= 0 || (unsigned long long)length.QuadPart > SIZE_MAX)
+	{
+		CloseHandle(file);
+		return NULL;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (!mapping) return NULL;
+
+	// The view keeps the mapping (and file) alive; pages are read in on first touch
+	const uint8_t* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+
+	if (!data)
+		return NULL;
+
+	*size = (size_t)length.QuadPart;
+	return data;
+}
+
+void assets_unmap_file(const uint8_t* data, size_t size)
+{
+	(void)size;
+
+	if (data)
+		UnmapViewOfFile(data);
+}
+
+#endif // _WIN32
@@ -0,0 +1,188 @@
+/*
+ * async_io.c - Batch bookkeeping and the thread-pool backend
+ *
+ * Reads go to the kernel ring when it is running and has room; everything
+ * else is queued for ASYNC_IO_THREADS workers doing blocking positional
+ * reads. A batch counts down its pending reads and calls back when the last
+ * one finishes, whichever backend served it.
+ */
+
+#include "async_io.h"
+#include "thread.h"
+#include <stdlib.h>
+
+static struct
+{
+	Mutex* mutex;
+	CondVar* wake;		// workers: queue not empty or quit
+	CondVar* idle;		// shutdown: nothing outstanding
+
+	Thread* threads[ASYNC_IO_THREADS];
+	int thread_count;
+	bool ring;
+	bool quit;
+
+	AsyncRead* head;
+	AsyncRead* tail;
+	int outstanding;
+} io;
+
+static void io_worker(void* arg)
+{
+	(void)arg;
+
+	mutex_lock(io.mutex);
+	for (;;)
+	{
+		while (!io.quit && !io.head)
+			condvar_wait(io.wake, io.mutex);
+
+		if (!io.head)
+			break;
+
+		AsyncRead* read = io.head;
+		io.head = read->next;
+		if (!io.head)
+			io.tail = NULL;
+
+		mutex_unlock(io.mutex);
+		async_io_complete(read, async_file_read_at(read->file, read->offset, read->buffer, read->size));
+		mutex_lock(io.mutex);
+	}
+	mutex_unlock(io.mutex);
+}
+
+void async_io_init(bool use_ring)
+{
+	if (io.mutex) return;
+
+	io.mutex = mutex_create();
+	io.wake = condvar_create();
+	io.idle = condvar_create();
+	io.quit = false;
+	io.outstanding = 0;
+
+	io.ring = use_ring && async_io_ring_start(ASYNC_IO_RING_DEPTH);
+
+	// The pool also takes the overflow of a full ring
+	io.thread_count = 0;
+	for (int i = 0; i < ASYNC_IO_THREADS; i++)
+	{
+		io.threads[io.thread_count] = thread_create(io_worker, NULL);
+		if (io.threads[io.thread_count])
+			io.thread_count++;
+	}
+}
+
+void async_io_shutdown(void)
+{
+	if (!io.mutex) return;
+
+	mutex_lock(io.mutex);
+	while (io.outstanding > 0)
+		condvar_wait(io.idle, io.mutex);
+
+	io.quit = true;
+	condvar_broadcast(io.wake);
+	mutex_unlock(io.mutex);
+
+	for (int i = 0; i < io.thread_count; i++)
+		thread_join(io.threads[i]);
+	io.thread_count = 0;
+
+	if (io.ring)
+		async_io_ring_stop();
+	io.ring = false;
+
+	condvar_destroy(io.idle);
+	condvar_destroy(io.wake);
+	mutex_destroy(io.mutex);
+	io.idle = NULL;
+	io.wake = NULL;
+	io.mutex = NULL;
+}
+
+const char* async_io_backend(void)
+{
+	if (io.ring) return "io_uring";
+	if (io.thread_count > 0) return "threads";
+	return "none";
+}
+
+void async_io_complete(AsyncRead* read, bool ok)
+{
+	AsyncBatch* batch = read->batch;
+	read->ok = ok;
+
+	// The last read hands the batch back; it must not be touched after that
+	if (atomic_fetch_sub_explicit(&batch->pending, 1, memory_order_acq_rel) == 1 && batch->done)
+		batch->done(batch);
+
+	mutex_lock(io.mutex);
+	if (--io.outstanding == 0)
+		condvar_broadcast(io.idle);
+	mutex_unlock(io.mutex);
+}
+
+void async_io_submit(AsyncBatch* batch)
+{
+	if (!io.mutex)
+	{
+		async_io_run(batch);
+		if (batch->done)
+			batch->done(batch);
+		return;
+	}
+
+	if (batch->count == 0)
+	{
+		if (batch->done)
+			batch->done(batch);
+		return;
+	}
+
+	atomic_store_explicit(&batch->pending, batch->count, memory_order_relaxed);
+
+	mutex_lock(io.mutex);
+	io.outstanding += batch->count;
+	mutex_unlock(io.mutex);
+
+	// Read the count first: once the last read is queued the batch may already be done
+	int count = batch->count;
+	AsyncRead* reads = batch->reads;
+
+	for (int i = 0; i < count; i++)
+	{
+		AsyncRead* read = &reads[i];
+		read->batch = batch;
+		read->next = NULL;
+		read->ok = false;
+
+		if (io.ring && async_io_ring_submit(read))
+			continue;
+
+		if (io.thread_count == 0)
+		{
+			async_io_complete(read, async_file_read_at(read->file, read->offset, read->buffer, read->size));
+			continue;
+		}
+
+		mutex_lock(io.mutex);
+		if (io.tail)
+			io.tail->next = read;
+		else
+			io.head = read;
+		io.tail = read;
+		condvar_signal(io.wake);
+		mutex_unlock(io.mutex);
+	}
+}
+
+void async_io_run(AsyncBatch* batch)
+{
+	for (int i = 0; i < batch->count; i++)
+	{
+		AsyncRead* read = &batch->reads[i];
+		read->ok = async_file_read_at(read->file, read->offset, read->buffer, read->size);
+	}
+}
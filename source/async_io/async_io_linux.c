@@ -0,0 +1,388 @@
+#ifdef __linux__
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "async_io.h"
+#include "thread.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define ASYNC_IO_HAVE_RING 1
+#endif
+
+struct AsyncFile
+{
+	int fd;
+};
+
+AsyncFile* async_file_open(const char* path)
+{
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return NULL;
+
+	AsyncFile* file = malloc(sizeof(AsyncFile));
+	if (!file)
+	{
+		close(fd);
+		return NULL;
+	}
+
+	file->fd = fd;
+	return file;
+}
+
+void async_file_close(AsyncFile* file)
+{
+	if (!file) return;
+
+	close(file->fd);
+	free(file);
+}
+
+bool async_file_read_at(AsyncFile* file, uint64_t offset, void* buffer, size_t size)
+{
+	uint8_t* out = buffer;
+
+	while (size > 0)
+	{
+		ssize_t got = pread(file->fd, out, size, (off_t)offset);
+		if (got < 0 && errno == EINTR)
+			continue;
+		if (got <= 0)
+			return false;
+
+		out += got;
+		offset += (uint64_t)got;
+		size -= (size_t)got;
+	}
+
+	return true;
+}
+
+#ifdef ASYNC_IO_HAVE_RING
+
+/*
+ * io_uring without liburing: the submission and completion rings are shared
+ * with the kernel through mmap, and io_uring_enter both submits and waits.
+ * Submissions are serialised by a mutex; a single completion thread reaps
+ * the ring and finishes reads. Short reads (or errors the ring reports) are
+ * redone with pread on that thread, so a batch always ends with full data
+ * or a failed read. A submission the kernel refuses is taken back and goes to
+ * the thread pool. If waiting on the ring itself starts failing, the ring
+ * takes no more reads and the completion thread polls it until the reads it
+ * still holds have come back.
+ */
+
+static struct
+{
+	int fd;
+	Mutex* mutex;
+	Thread* reaper;
+
+	void* sq_ring;
+	size_t sq_ring_size;
+	void* cq_ring;
+	size_t cq_ring_size;
+	struct io_uring_sqe* sqes;
+	size_t sqes_size;
+
+	unsigned* sq_head;
+	unsigned* sq_tail;
+	unsigned* sq_mask;
+	unsigned* sq_entries;
+	unsigned* sq_array;
+
+	unsigned* cq_head;
+	unsigned* cq_tail;
+	unsigned* cq_mask;
+	struct io_uring_cqe* cqes;
+
+	unsigned in_flight;	// reads not reaped yet; kept within the SQ size so the CQ cannot overflow
+	bool failed;		// waiting for completions failed; new reads go to the thread pool
+	bool stopping;		// shutdown asked for; the completion thread exits once nothing is in flight
+} ring = { .fd = -1 };
+
+static int ring_enter(unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+	return (int)syscall(__NR_io_uring_enter, ring.fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static void ring_unmap(void)
+{
+	if (ring.sqes)
+		munmap(ring.sqes, ring.sqes_size);
+	if (ring.cq_ring && ring.cq_ring != ring.sq_ring)
+		munmap(ring.cq_ring, ring.cq_ring_size);
+	if (ring.sq_ring)
+		munmap(ring.sq_ring, ring.sq_ring_size);
+
+	ring.sqes = NULL;
+	ring.cq_ring = NULL;
+	ring.sq_ring = NULL;
+
+	if (ring.fd >= 0)
+		close(ring.fd);
+	ring.fd = -1;
+}
+
+/* Queue one SQE; the caller holds ring.mutex */
+static bool ring_push(const struct io_uring_sqe* sqe)
+{
+	unsigned tail = *ring.sq_tail;
+	unsigned head = __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE);
+
+	if (ring.failed || tail - head >= *ring.sq_entries || ring.in_flight >= *ring.sq_entries)
+		return false;
+
+	unsigned index = tail & *ring.sq_mask;
+	ring.sqes[index] = *sqe;
+	ring.sq_array[index] = index;
+	__atomic_store_n(ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+	ring.in_flight++;
+
+	int submitted;
+	do
+		submitted = ring_enter(1, 0, 0);
+	while (submitted < 0 && errno == EINTR);
+
+	// Nothing was consumed (e.g. EAGAIN, EBUSY), so the entry can be taken back
+	if (submitted < 1)
+	{
+		__atomic_store_n(ring.sq_tail, tail, __ATOMIC_RELEASE);
+		ring.in_flight--;
+		return false;
+	}
+
+	return true;
+}
+
+static void ring_finish(AsyncRead* read, int result)
+{
+	if (result >= 0 && (size_t)result == read->size)
+	{
+		async_io_complete(read, true);
+		return;
+	}
+
+	// Short read or an error from the ring: redo it the plain way
+	async_io_complete(read, async_file_read_at(read->file, read->offset, read->buffer, read->size));
+}
+
+static void ring_reap(void* arg)
+{
+	(void)arg;
+
+	// Once waiting fails the ring is only polled, so the thread never blocks on it again
+	bool polling = false;
+
+	for (;;)
+	{
+		if (ring_enter(0, polling ? 0 : 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+			polling = true;
+
+		unsigned head = *ring.cq_head;
+		unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+		bool quit = false;
+
+		while (head != tail)
+		{
+			struct io_uring_cqe* cqe = &ring.cqes[head & *ring.cq_mask];
+			uint64_t user_data = cqe->user_data;
+			int result = cqe->res;
+
+			// Free the slot before finishing, which may submit more work
+			head++;
+			__atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+
+			mutex_lock(ring.mutex);
+			ring.in_flight--;
+			mutex_unlock(ring.mutex);
+
+			if (user_data == 0)
+				quit = true;
+			else
+				ring_finish((AsyncRead*)(uintptr_t)user_data, result);
+		}
+
+		if (quit)
+			break;
+
+		// Once polling, stop feeding the ring and poll for the reads it still holds
+		mutex_lock(ring.mutex);
+		if (polling)
+			ring.failed = true;
+		bool done = ring.stopping && ring.in_flight == 0;
+		mutex_unlock(ring.mutex);
+
+		if (done)
+			break;
+		if (polling)
+			usleep(1000);
+	}
+}
+
+bool async_io_ring_start(unsigned depth)
+{
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	// Fails with ENOSYS on old kernels and EPERM where io_uring is disabled or filtered
+	ring.fd = (int)syscall(__NR_io_uring_setup, depth, &params);
+	if (ring.fd < 0)
+	{
+		ring.fd = -1;
+		return false;
+	}
+
+	ring.sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	ring.cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+	bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (single && ring.cq_ring_size > ring.sq_ring_size)
+		ring.sq_ring_size = ring.cq_ring_size;
+
+	ring.sq_ring = mmap(NULL, ring.sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+		ring.fd, IORING_OFF_SQ_RING);
+	if (ring.sq_ring == MAP_FAILED)
+	{
+		ring.sq_ring = NULL;
+		ring_unmap();
+		return false;
+	}
+
+	if (single)
+		ring.cq_ring = ring.sq_ring;
+	else
+	{
+		ring.cq_ring = mmap(NULL, ring.cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			ring.fd, IORING_OFF_CQ_RING);
+		if (ring.cq_ring == MAP_FAILED)
+		{
+			ring.cq_ring = NULL;
+			ring_unmap();
+			return false;
+		}
+	}
+
+	ring.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring.sqes = mmap(NULL, ring.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+		ring.fd, IORING_OFF_SQES);
+	if (ring.sqes == MAP_FAILED)
+	{
+		ring.sqes = NULL;
+		ring_unmap();
+		return false;
+	}
+
+	uint8_t* sq = ring.sq_ring;
+	ring.sq_head = (unsigned*)(sq + params.sq_off.head);
+	ring.sq_tail = (unsigned*)(sq + params.sq_off.tail);
+	ring.sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+	ring.sq_entries = (unsigned*)(sq + params.sq_off.ring_entries);
+	ring.sq_array = (unsigned*)(sq + params.sq_off.array);
+
+	uint8_t* cq = ring.cq_ring;
+	ring.cq_head = (unsigned*)(cq + params.cq_off.head);
+	ring.cq_tail = (unsigned*)(cq + params.cq_off.tail);
+	ring.cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+	ring.cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+	ring.mutex = mutex_create();
+	ring.in_flight = 0;
+	ring.failed = false;
+	ring.stopping = false;
+	ring.reaper = thread_create(ring_reap, NULL);
+	if (!ring.reaper)
+	{
+		mutex_destroy(ring.mutex);
+		ring.mutex = NULL;
+		ring_unmap();
+		return false;
+	}
+
+	return true;
+}
+
+bool async_io_ring_submit(AsyncRead* read)
+{
+	// The length field of an SQE is 32 bits
+	if (read->size > UINT32_MAX)
+		return false;
+
+	struct io_uring_sqe sqe;
+	memset(&sqe, 0, sizeof(sqe));
+	sqe.opcode = IORING_OP_READ;
+	sqe.fd = read->file->fd;
+	sqe.off = read->offset;
+	sqe.addr = (uint64_t)(uintptr_t)read->buffer;
+	sqe.len = (uint32_t)read->size;
+	sqe.user_data = (uint64_t)(uintptr_t)read;
+
+	mutex_lock(ring.mutex);
+	bool queued = ring_push(&sqe);
+	mutex_unlock(ring.mutex);
+
+	return queued;
+}
+
+void async_io_ring_stop(void)
+{
+	// A no-op with no read attached tells the completion thread to exit
+	struct io_uring_sqe sqe;
+	memset(&sqe, 0, sizeof(sqe));
+	sqe.opcode = IORING_OP_NOP;
+
+	// The thread also exits once stopping is set and nothing is in flight, so the
+	// no-op only has to wake it from an empty ring: retry it while the kernel refuses
+	// it, unless the thread is polling or has reads coming back to wake it
+	for (;;)
+	{
+		mutex_lock(ring.mutex);
+		bool queued = ring_push(&sqe);
+		ring.stopping = true;
+		bool wakes = queued || ring.failed || ring.in_flight > 0;
+		mutex_unlock(ring.mutex);
+
+		if (wakes)
+			break;
+		usleep(1000);
+	}
+
+	thread_join(ring.reaper);
+	ring.reaper = NULL;
+
+	mutex_destroy(ring.mutex);
+	ring.mutex = NULL;
+	ring_unmap();
+}
+
+#else
+
+bool async_io_ring_start(unsigned depth)
+{
+	(void)depth;
+	return false;
+}
+
+bool async_io_ring_submit(AsyncRead* read)
+{
+	(void)read;
+	return false;
+}
+
+void async_io_ring_stop(void)
+{
+}
+
+#endif // ASYNC_IO_HAVE_RING
+
+#endif // __linux__
@@ -0,0 +1,79 @@
+#ifdef _WIN32
+
+#include "async_io.h"
+#include <windows.h>
+#include <stdlib.h>
+
+struct AsyncFile
+{
+	HANDLE handle;
+};
+
+AsyncFile* async_file_open(const char* path)
+{
+	HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (handle == INVALID_HANDLE_VALUE) return NULL;
+
+	AsyncFile* file = malloc(sizeof(AsyncFile));
+	if (!file)
+	{
+		CloseHandle(handle);
+		return NULL;
+	}
+
+	file->handle = handle;
+	return file;
+}
+
+void async_file_close(AsyncFile* file)
+{
+	if (!file) return;
+
+	CloseHandle(file->handle);
+	free(file);
+}
+
+bool async_file_read_at(AsyncFile* file, uint64_t offset, void* buffer, size_t size)
+{
+	uint8_t* out = buffer;
+
+	while (size > 0)
+	{
+		// The offset goes in the OVERLAPPED, so threads sharing the handle do not race on a file pointer
+		OVERLAPPED at = { 0 };
+		at.Offset = (DWORD)offset;
+		at.OffsetHigh = (DWORD)(offset >> 32);
+
+		DWORD chunk = size > 0x40000000 ? 0x40000000 : (DWORD)size;
+		DWORD got = 0;
+		if (!ReadFile(file->handle, out, chunk, &got, &at) || got == 0)
+			return false;
+
+		out += got;
+		offset += got;
+		size -= got;
+	}
+
+	return true;
+}
+
+/* No kernel ring here; every read goes through the thread pool */
+
+bool async_io_ring_start(unsigned depth)
+{
+	(void)depth;
+	return false;
+}
+
+bool async_io_ring_submit(AsyncRead* read)
+{
+	(void)read;
+	return false;
+}
+
+void async_io_ring_stop(void)
+{
+}
+
+#endif // _WIN32
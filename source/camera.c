@@ -1,6 +1,31 @@
 #include "camera.h"
+#include <math.h>
 
 Mat4 camera_get_view_matrix(Camera* cam)
 {
 	return mat4_look_at(cam->position, cam->target, cam->up);
-}
\ No newline at end of file
+}
+
+CameraCardinal camera_cardinal(Mat4 view)
+{
+	// World-space direction along which view-space z decreases fastest
+	float fx = -view.m[0][2];
+	float fz = -view.m[2][2];
+
+	if (fabsf(fx) > fabsf(fz))
+		return fx > 0.0f ? CAMERA_EAST : CAMERA_WEST;
+
+	return fz > 0.0f ? CAMERA_SOUTH : CAMERA_NORTH;
+}
+
+Vec3 camera_cardinal_forward(CameraCardinal facing)
+{
+	switch (facing)
+	{
+		case CAMERA_NORTH: return (Vec3){  0.0f, 0.0f, -1.0f };
+		case CAMERA_EAST:  return (Vec3){  1.0f, 0.0f,  0.0f };
+		case CAMERA_SOUTH: return (Vec3){  0.0f, 0.0f,  1.0f };
+		case CAMERA_WEST:  return (Vec3){ -1.0f, 0.0f,  0.0f };
+		default:           return (Vec3){  0.0f, 0.0f,  0.0f };
+	}
+}
@@ -7,7 +7,9 @@
 #include "ui_skin.h"
 #include "ui.h"
 #include "sketch.h"
+#include "workers.h"
 #include "achievements.h"
+#include "assets.h"
 #include "world/world.h"
 #include "lighting/directional_light.h"
 
@@ -38,6 +40,9 @@ void game_init(void)
 {
 	input_init();
 	achievements_init();
+	workers_init(0);
+
+	sketch_set_binned(true);
 
 	ui_set_skin(SKIN_GLYPHBORN);
 
@@ -48,7 +53,13 @@ void game_init(void)
 	view = camera_get_view_matrix(&main_camera);
 	projection = mat4_perspective(3.14159f / 4.0f, (float)FB_WIDTH / (float)FB_HEIGHT, 0.1f, 100.0f);
 
-	world_init(&world, main_camera.position.x, main_camera.position.z);
+	// Without a pack the world comes from the embedded data, if the build has it
+	assets_open(ASSET_PACK_FILE);
+	// Start centred on the cell world_update will compute, so the first window is kept
+	world_init(&world,
+		world_cell_coord(main_camera.position.x, MAP_WIDTH),
+		world_cell_coord(main_camera.position.z, MAP_HEIGHT),
+		NULL);
 
 	sun = (DirectionalLight){
 		.dir = vec3_normalize((Vec3){ -0.4f, -1.0f, 0.2f }),
@@ -137,6 +148,8 @@ void game_render(void)
     view = camera_get_view_matrix(&main_camera);
 
 	world_render(&world, view, projection);
+
+	sketch_flush();
 }
 
 void game_render_ui(void)
@@ -176,4 +189,6 @@ void game_shutdown(void)
 {
 	achievements_shutdown();
 	world_free(&world);
+	assets_close();
+	workers_shutdown();
 }
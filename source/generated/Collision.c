@@ -8,11 +8,11 @@ extern const uint8_t _binary_data_layouts_zero_0_0_collision_bin_start[] __asm__
 const Blob g_Collision[] = {
     {
         _binary_data_layouts_test_map_0_0_collision_bin_start,
-        32774
+        32784
     },
     {
         _binary_data_layouts_zero_0_0_collision_bin_start,
-        32774
+        32784
     },
 };
 
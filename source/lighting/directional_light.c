@@ -0,0 +1,22 @@
+#include "lighting/directional_light.h"
+#include <math.h>
+
+Vec3 directional_light_face_normal(Vec3 a, Vec3 b, Vec3 c)
+{
+	Vec3 normal = vec3_cross(vec3_sub(b, a), vec3_sub(c, a));
+
+	float len_sq = normal.x * normal.x + normal.y * normal.y + normal.z * normal.z;
+	if (len_sq < 1e-6f)
+		return (Vec3) { 0.0f, 0.0f, 0.0f };
+
+	return vec3_normalize(normal);
+}
+
+float directional_light_factor(const DirectionalLight* light, Vec3 normal)
+{
+	float ndotl = vec3_dot(normal, vec3_neg(light->dir));
+	float diffuse = fmaxf(0.0f, ndotl);
+
+	float factor = light->ambient + diffuse * light->intensity;
+	return fminf(fmaxf(factor, 0.0f), 1.0f);
+}
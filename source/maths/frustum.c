@@ -0,0 +1,36 @@
+#include "maths/frustum.h"
+
+Frustum frustum_from_matrix(Mat4 clip)
+{
+	// Rows of the matrix; a point is inside when -w <= x, y, z <= w
+	Vec4 row[4];
+	for (int r = 0; r < 4; r++)
+		row[r] = (Vec4){ clip.m[0][r], clip.m[1][r], clip.m[2][r], clip.m[3][r] };
+
+	Frustum frustum;
+	frustum.planes[0] = vec4_add(row[3], row[0]);	// Left
+	frustum.planes[1] = vec4_sub(row[3], row[0]);	// Right
+	frustum.planes[2] = vec4_add(row[3], row[1]);	// Bottom
+	frustum.planes[3] = vec4_sub(row[3], row[1]);	// Top
+	frustum.planes[4] = vec4_add(row[3], row[2]);	// Near
+	frustum.planes[5] = vec4_sub(row[3], row[2]);	// Far
+	return frustum;
+}
+
+bool frustum_intersects_aabb(const Frustum* frustum, Vec3 min, Vec3 max)
+{
+	for (int i = 0; i < 6; i++)
+	{
+		const Vec4* p = &frustum->planes[i];
+
+		// Corner furthest along the plane normal
+		float x = p->x >= 0.0f ? max.x : min.x;
+		float y = p->y >= 0.0f ? max.y : min.y;
+		float z = p->z >= 0.0f ? max.z : min.z;
+
+		if (p->x * x + p->y * y + p->z * z + p->w < 0.0f)
+			return false;
+	}
+
+	return true;
+}
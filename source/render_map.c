@@ -1,68 +1,144 @@
 #include "render_map.h"
 #include "sketch.h"
+#include "maths/frustum.h"
 
-void render_map(
-    const GeometryMap* geo,
-    const Tileset* regional,
-    const Tileset* local,
-    const Tileset* interior,
-    Mat4 model,
-    Mat4 view,
-    Mat4 projection
-)
+/* Brick indices ordered nearest-first for a camera looking towards @facing */
+static void render_map_brick_order(CameraCardinal facing, int order[CHUNK_BRICK_COUNT])
 {
-    for (int layer = 0; layer < MAP_LAYERS; layer++)
+    bool along_x = facing == CAMERA_EAST || facing == CAMERA_WEST;
+    bool backwards = facing == CAMERA_NORTH || facing == CAMERA_WEST;
+    int depth_count = along_x ? CHUNK_BRICKS_X : CHUNK_BRICKS_Z;
+    int side_count = along_x ? CHUNK_BRICKS_Z : CHUNK_BRICKS_X;
+    int n = 0;
+
+    for (int depth = 0; depth < depth_count; depth++)
     {
-        for (int y = 0; y < MAP_HEIGHT; y++)
+        int d = backwards ? depth_count - 1 - depth : depth;
+
+        for (int by = 0; by < CHUNK_BRICKS_Y; by++)
         {
-            for (int x = 0; x < MAP_WIDTH; x++)
+            for (int side = 0; side < side_count; side++)
             {
-                TileRef ref = geo->tiles[layer][y][x];
-
-                uint8_t tileset_id  = tile_get_tileset(ref);
-                uint16_t tile_id    = tile_get_id(ref);
-
-                const TileMesh* tile = NULL;
-
-                switch (tileset_id)
-                {
-                    case 0: tile = &regional->tiles[tile_id]; break;
-                    case 1: tile = &local->tiles[tile_id]; break;
-                    case 2: tile = &interior->tiles[tile_id]; break;
-                    default: continue;
-                }
-
-                if (!tile || tile->vertex_count == 0)
-                    continue;
-
-                RasterVertex rv[tile->vertex_count];
-
-                for (uint32_t i = 0; i < tile->vertex_count; i++)
-                {
-                    rv[i].x = tile->vertices[i].x;
-                    rv[i].y = tile->vertices[i].y;
-                    rv[i].z = tile->vertices[i].z;
-                    rv[i].u = tile->vertices[i].u;
-                    rv[i].v = tile->vertices[i].v;
-                }
-
-                RasterMesh rm = {
-                    .vertices       = rv,
-                    .vertex_count   = tile->vertex_count,
-                    .indices        = tile->indices,
-                    .index_count    = tile->index_count,
-                    .pixels         = tile->pixels,
-                    .tex_width      = tile->texture_width,
-                    .tex_height     = tile->texture_height
-                };
-
-                Mat4 tile_model = mat4_multiply(
-                    model,
-                    mat4_translate((Vec3) { (float)x, (float)layer, (float)y})
-                );
-
-                sketch_draw_mesh(&rm, tile_model, view, projection);
+                int bx = along_x ? d : side;
+                int bz = along_x ? side : d;
+                order[n++] = CHUNK_BRICK_INDEX(bx, by, bz);
             }
         }
     }
 }
+
+/* Model-space position of the eye: the point @model_view maps to the origin */
+static Vec3 render_map_eye(Mat4 model_view)
+{
+    const float (*m)[4] = model_view.m;
+    Vec3 t = { -m[3][0], -m[3][1], -m[3][2] };
+
+    // Solve m[0] * x + m[1] * y + m[2] * z = t by Cramer's rule; columns hold the axes
+    Vec3 c0 = { m[0][0], m[0][1], m[0][2] };
+    Vec3 c1 = { m[1][0], m[1][1], m[1][2] };
+    Vec3 c2 = { m[2][0], m[2][1], m[2][2] };
+
+    float det = vec3_dot(c0, vec3_cross(c1, c2));
+    if (det == 0.0f)
+        return (Vec3){ 0.0f, 0.0f, 0.0f };
+
+    return (Vec3){
+        vec3_dot(t, vec3_cross(c1, c2)) / det,
+        vec3_dot(c0, vec3_cross(t, c2)) / det,
+        vec3_dot(c0, vec3_cross(c1, t)) / det
+    };
+}
+
+/* Whether every triangle of @brick's list for @facing faces an eye at @eye */
+static bool render_map_brick_faces_eye(const ChunkMesh* mesh, const ChunkBrick* brick, CameraCardinal facing, Vec3 eye)
+{
+    uint16_t count = brick->facing_count[facing];
+    if (count == CHUNK_FACING_MIXED)
+        return false;
+
+    const ChunkFacing* planes = &mesh->views[facing].facing[brick->facing_first[facing]];
+    for (uint16_t i = 0; i < count; i++)
+    {
+        if (vec3_dot(mesh->normals[planes[i].normal], eye) <= planes[i].height + CHUNK_FACING_EPSILON)
+            return false;
+    }
+
+    return true;
+}
+
+void render_map(
+    const ChunkMesh* mesh,
+    Mat4 model,
+    Mat4 view,
+    Mat4 projection,
+    CameraCardinal facing,
+    bool front_to_back
+)
+{
+    if (mesh->index_count == 0)
+        return;
+
+    Mat4 model_view = mat4_multiply(view, model);
+    Frustum frustum = frustum_from_matrix(mat4_multiply(projection, model_view));
+    Vec3 eye = render_map_eye(model_view);
+    const ChunkFaces* faces = &mesh->views[facing];
+
+    int order[CHUNK_BRICK_COUNT];
+    if (front_to_back)
+        render_map_brick_order(facing, order);
+    else
+        for (int i = 0; i < CHUNK_BRICK_COUNT; i++)
+            order[i] = i;
+
+    for (int i = 0; i < CHUNK_BRICK_COUNT; i++)
+    {
+        const ChunkBrick* brick = &mesh->bricks[order[i]];
+        uint32_t first = brick->view_first[facing];
+        uint32_t count = brick->view_count[facing];
+
+        if (count == 0 || !frustum_intersects_aabb(&frustum, brick->min, brick->max))
+            continue;
+
+        // The list already lacks the faces pointing away; when the eye is in
+        // front of every plane the rest face it too, so no triangle is tested
+        bool facing_eye = render_map_brick_faces_eye(mesh, brick, facing, eye);
+
+        RasterMesh rm = {
+            .vertices       = mesh->vertices + brick->vertex_first,
+            .vertex_count   = brick->vertex_count,
+            .indices        = faces->indices + first * 3,
+            .index_count    = count * 3,
+            .textures       = mesh->textures,
+            .face_textures  = faces->face_textures + first,
+            .cull           = facing_eye ? RASTER_CULL_NONE : RASTER_CULL_CW,
+            .face_light     = mesh->normal_light,
+            .face_light_ids = faces->face_normals + first
+        };
+
+        sketch_draw_mesh(&rm, model, view, projection);
+    }
+}
+
+void render_lod(
+    const LodMesh* mesh,
+    Mat4 model,
+    Mat4 view,
+    Mat4 projection
+)
+{
+    if (mesh->index_count == 0)
+        return;
+
+    RasterMesh rm = {
+        .vertices     = mesh->vertices,
+        .vertex_count = mesh->vertex_count,
+        .indices      = mesh->indices,
+        .index_count  = mesh->index_count,
+        .pixels       = &mesh->colors[0][0],
+        .tex_width    = MAP_WIDTH,
+        .tex_height   = MAP_HEIGHT,
+        .cull         = RASTER_CULL_CW
+    };
+
+    sketch_draw_mesh(&rm, model, view, projection);
+}
\ No newline at end of file
@@ -8,13 +8,20 @@
 
 #include "sketch.h"
 #include "render.h"
+#include "workers.h"
 #include "maths/vec4.h"
 #include "lighting/directional_light.h"
 #include <string.h>
+#include <stdlib.h>
 #include <math.h>
 
 #include <stdio.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SKETCH_X86_SIMD 1
+#endif
+
 /* External depth buffer used for depth testing (defined in platform renderer)
  * Each pixel holds the current minimum depth; lower values are closer.
  */
@@ -39,12 +46,93 @@ typedef struct {
 } RasterVert;
 
 /* =================================
- * Utility
+ * Set-up triangle
+ *
+ * Screen-space triangle plus everything needed to shade it, so it can be
+ * rasterized later (and on another thread) without touching the mesh again.
+ *
+ * Vertices are snapped to 28.4 fixed point and every edge is kept as the
+ * exact integer function E(px, py) = a * px + b * py + c over sub-pixel
+ * coordinates. Stepping one pixel is an integer add, and the top-left fill
+ * rule becomes a per-edge threshold, so pixels on an edge shared by two
+ * triangles are covered by exactly one of them.
   ================================== */
-static inline float edge(float ax, float ay, float bx, float by, float cx, float cy)
-{
-	return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
-}
+#define SUBPIXEL_BITS	4
+#define SUBPIXEL_ONE	(1 << SUBPIXEL_BITS)
+#define SUBPIXEL_HALF	(SUBPIXEL_ONE / 2)
+
+/* Snapped coordinates beyond this magnitude could overflow the int64 edge terms */
+#define SUBPIXEL_LIMIT	(1 << 28)
+
+typedef struct {
+	int64_t a, b, c;
+	int64_t threshold;		// Covered when E > threshold: -1 on top/left edges, 0 otherwise
+} RasterEdge;
+
+typedef struct {
+	RasterVert a, b, c;
+	RasterEdge edges[3];		// edges[0] = b->c, edges[1] = c->a, edges[2] = a->b
+	float inv_area;
+	float zmin;					// Conservative lower bound of the depth of every covered pixel
+	bool fits32;				// Every edge value inside the bounding box fits in int32
+	int minX, minY, maxX, maxY;	// Pixel bounding box, clamped to the framebuffer
+
+	const uint32_t* pixels;
+	uint16_t tex_width;
+	uint16_t tex_height;
+	bool wrap;
+	float light;
+} RasterTri;
+
+/* =================================
+ * Tile bins
+ *
+ * In binned mode triangles are queued in submission order and every screen
+ * tile they overlap records their queue index. `sketch_flush` rasterizes the
+ * tiles in parallel; each tile walks its list in order, so every pixel sees
+ * exactly the same sequence of depth tests and writes as the serial path.
+  ================================== */
+#define BIN_SIZE	32
+#define BIN_COLS	((FB_WIDTH + BIN_SIZE - 1) / BIN_SIZE)
+#define BIN_ROWS	((FB_HEIGHT + BIN_SIZE - 1) / BIN_SIZE)
+#define BIN_COUNT	(BIN_COLS * BIN_ROWS)
+
+typedef struct {
+	uint32_t* tris;
+	uint32_t count;
+	uint32_t capacity;
+} RasterBin;
+
+static bool binned = false;
+
+static RasterTri* tri_queue = NULL;
+static uint32_t tri_count = 0;
+static uint32_t tri_capacity = 0;
+
+static RasterBin bins[BIN_COUNT];
+
+/* =================================
+ * Hierarchical depth
+ *
+ * Coarse copy of `depthbuffer` holding the farthest depth of every 8x8
+ * block. A triangle whose nearest possible depth is not in front of that is
+ * rejected for the whole block without touching a pixel. Blocks are only
+ * marked dirty when drawn to and recomputed when next queried. Blocks never
+ * straddle a tile, so tiles rasterized in parallel own their blocks.
+  ================================== */
+#define HIZ_SIZE	8
+#define HIZ_COLS	(FB_WIDTH / HIZ_SIZE)
+#define HIZ_ROWS	(FB_HEIGHT / HIZ_SIZE)
+#define HIZ_COUNT	(HIZ_COLS * HIZ_ROWS)
+
+/* Covers float rounding in the interpolated depth, keeping rejection exact */
+#define HIZ_BIAS	1e-5f
+
+_Static_assert(BIN_SIZE % HIZ_SIZE == 0, "depth blocks must not straddle tiles");
+_Static_assert(FB_WIDTH % HIZ_SIZE == 0 && FB_HEIGHT % HIZ_SIZE == 0, "depth blocks must tile the framebuffer");
+
+static float hiz_max[HIZ_COUNT];
+static bool hiz_dirty[HIZ_COUNT];
 
 void sketch_show_uvs(bool showUVs)
 {
@@ -53,11 +141,22 @@ void sketch_show_uvs(bool showUVs)
 
 void sketch_clear(uint32_t clear_color)
 {
+	// Anything still queued would be drawn over the cleared frame, so drop it
+	tri_count = 0;
+	for (int i = 0; i < BIN_COUNT; i++)
+		bins[i].count = 0;
+
 	for (int i = 0; i < FB_WIDTH * FB_HEIGHT; i++)
 	{
 		framebuffer_game[i] = clear_color;
 		depthbuffer[i] = 1.0f;
 	}
+
+	for (int i = 0; i < HIZ_COUNT; i++)
+	{
+		hiz_max[i] = 1.0f;
+		hiz_dirty[i] = false;
+	}
 }
 
 typedef struct {
@@ -70,6 +169,37 @@ typedef struct {
     ClipVert v[3];
 } ClipTri;
 
+/* =================================
+ * Post-transform vertex cache
+ *
+ * Every vertex of a mesh is transformed once per draw: to clip space with a
+ * pre-multiplied MVP and, unless the mesh brings baked face lighting, to
+ * world space for lighting. Triangles then just index into these arrays.
+ * The buffers grow to the largest mesh seen.
+  ================================== */
+static Vec4* xform_clip = NULL;
+static Vec3* xform_world = NULL;
+static uint32_t xform_capacity = 0;
+
+static bool xform_reserve(uint32_t count)
+{
+    if (count <= xform_capacity) return true;
+
+    uint32_t capacity = xform_capacity ? xform_capacity : 256;
+    while (capacity < count) capacity *= 2;
+
+    Vec4* clip = realloc(xform_clip, capacity * sizeof(Vec4));
+    if (!clip) return false;
+    xform_clip = clip;
+
+    Vec3* world = realloc(xform_world, capacity * sizeof(Vec3));
+    if (!world) return false;
+    xform_world = world;
+
+    xform_capacity = capacity;
+    return true;
+}
+
 static ClipVert clip_lerp(const ClipVert* a, const ClipVert* b, float t)
 {
     ClipVert r;
@@ -156,93 +286,868 @@ static int clip_triangle_near(const ClipVert in[3], ClipTri out[2])
     return 0;
 }
 
-static void draw_triangle(RasterVert a, RasterVert b, RasterVert c, const RasterMesh* mesh, float light)
+/* Guard band as a multiple of w. A vertex inside it lands within 64 screens
+ * of the viewport, which snaps to 28.4 far below SUBPIXEL_LIMIT.
+ */
+#define GUARD_BAND 64.0f
+
+/* Most vertices a triangle can have after the four guard band planes */
+#define GUARD_MAX_VERTS 7
+
+static inline bool clip_in_guard_band(const ClipVert* v)
+{
+    return fabsf(v->p.x) <= GUARD_BAND * v->p.w && fabsf(v->p.y) <= GUARD_BAND * v->p.w;
+}
+
+/* Signed distance to guard plane @plane (0-3: left, right, bottom, top); >= 0 = inside */
+static inline float guard_distance(const ClipVert* v, int plane)
+{
+    float g = GUARD_BAND * v->p.w;
+
+    switch (plane) {
+        case 0:  return g + v->p.x;
+        case 1:  return g - v->p.x;
+        case 2:  return g + v->p.y;
+        default: return g - v->p.y;
+    }
+}
+
+// Clip a triangle already in front of the near plane against the guard band,
+// so every vertex can be snapped to fixed point. Returns the vertex count of
+// the convex polygon left in 'out' (0 or 3 to GUARD_MAX_VERTS).
+static int clip_triangle_guard(const ClipVert in[3], ClipVert out[GUARD_MAX_VERTS])
+{
+    // Four planes swap the buffers an even number of times, so the result ends up in 'out'
+    ClipVert buffer[GUARD_MAX_VERTS];
+    ClipVert* src = out;
+    ClipVert* dst = buffer;
+    int count = 3;
+
+    for (int i = 0; i < 3; i++)
+        src[i] = in[i];
+
+    for (int plane = 0; plane < 4; plane++) {
+        int kept = 0;
+
+        for (int i = 0; i < count; i++) {
+            const ClipVert* a = &src[i];
+            const ClipVert* b = &src[(i + 1) % count];
+            float da = guard_distance(a, plane);
+            float db = guard_distance(b, plane);
+
+            if (da >= 0.0f)
+                dst[kept++] = *a;
+            if ((da >= 0.0f) != (db >= 0.0f))
+                dst[kept++] = clip_lerp(a, b, da / (da - db));
+        }
+
+        ClipVert* t = src; src = dst; dst = t;
+        count = kept;
+        if (count < 3)
+            return 0;
+    }
+
+    return count;
+}
+
+/* =================================
+ * Culling
+ *
+ * Runs on unclipped clip-space triangles, so it has to be valid for
+ * vertices behind the camera as well.
+  ================================== */
+enum {
+    OUT_LEFT   = 1 << 0,
+    OUT_RIGHT  = 1 << 1,
+    OUT_BOTTOM = 1 << 2,
+    OUT_TOP    = 1 << 3,
+    OUT_NEAR   = 1 << 4,
+    OUT_FAR    = 1 << 5,
+};
+
+static inline int clip_outcode(Vec4 p)
+{
+    int code = 0;
+
+    if (p.x < -p.w) code |= OUT_LEFT;
+    if (p.x >  p.w) code |= OUT_RIGHT;
+    if (p.y < -p.w) code |= OUT_BOTTOM;
+    if (p.y >  p.w) code |= OUT_TOP;
+    if (p.z < -p.w) code |= OUT_NEAR;
+    if (p.z >  p.w) code |= OUT_FAR;
+
+    return code;
+}
+
+// True if the triangle is entirely outside one frustum plane, or faces away
+// from the camera according to `cull`.
+static bool cull_triangle(const ClipVert in[3], RasterCull cull)
+{
+    Vec4 p0 = in[0].p;
+    Vec4 p1 = in[1].p;
+    Vec4 p2 = in[2].p;
+
+    if (clip_outcode(p0) & clip_outcode(p1) & clip_outcode(p2))
+        return true;
+
+    if (cull == RASTER_CULL_NONE)
+        return false;
+
+    // Homogeneous orientation: det[x y w] equals the NDC signed area scaled by
+    // w0 * w1 * w2, and unlike the projected area it keeps the right sign when
+    // some vertices are behind the eye. Positive means counter-clockwise in NDC.
+    float det =
+        p0.x * (p1.y * p2.w - p2.y * p1.w) -
+        p1.x * (p0.y * p2.w - p2.y * p0.w) +
+        p2.x * (p0.y * p1.w - p1.y * p0.w);
+
+    if (cull == RASTER_CULL_CW)
+        return det <= 0.0f;
+
+    return det >= 0.0f;
+}
+
+static inline bool snap_subpixel(float v, int64_t* out)
+{
+	float scaled = v * SUBPIXEL_ONE;
+
+	// Also rejects NaN
+	if (!(fabsf(scaled) < SUBPIXEL_LIMIT)) return false;
+
+	*out = (int64_t)floorf(scaled + 0.5f);
+	return true;
+}
+
+/* Floor / ceiling of n / SUBPIXEL_ONE for signed n */
+static inline int64_t subpixel_floor(int64_t n)
+{
+	return n >= 0 ? n / SUBPIXEL_ONE : -((-n + SUBPIXEL_ONE - 1) / SUBPIXEL_ONE);
+}
+
+static inline int64_t subpixel_ceil(int64_t n)
+{
+	return -subpixel_floor(-n);
+}
+
+static void setup_edge(RasterEdge* e, int64_t px, int64_t py, int64_t qx, int64_t qy)
+{
+	int64_t dx = qx - px;
+	int64_t dy = qy - py;
+
+	e->a = -dy;
+	e->b = dx;
+	e->c = dy * px - dx * py;
+
+	// Interior lies where E grows; with y pointing down that makes an edge
+	// "top" when it is horizontal and runs right, and "left" when it runs up.
+	bool top_left = dy < 0 || (dy == 0 && dx > 0);
+	e->threshold = top_left ? -1 : 0;
+}
+
+static inline int64_t edge_at(const RasterEdge* e, int x, int y)
+{
+	int64_t px = (int64_t)x * SUBPIXEL_ONE + SUBPIXEL_HALF;
+	int64_t py = (int64_t)y * SUBPIXEL_ONE + SUBPIXEL_HALF;
+	return e->a * px + e->b * py + e->c;
+}
+
+static bool setup_triangle(RasterTri* tri, RasterVert a, RasterVert b, RasterVert c, const RasterTexture* texture, float light)
 {
-	float area = edge(a.x, a.y, b.x, b.y, c.x, c.y);
-	if (fabsf(area) < 1e-6f) return;
+	int64_t ax, ay, bx, by, cx, cy;
+	if (!snap_subpixel(a.x, &ax) || !snap_subpixel(a.y, &ay) ||
+		!snap_subpixel(b.x, &bx) || !snap_subpixel(b.y, &by) ||
+		!snap_subpixel(c.x, &cx) || !snap_subpixel(c.y, &cy))
+		return false;
+
+	int64_t area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+	if (area == 0) return false;
+
+	// Rasterize everything with positive area; swapping b and c flips the winding
+	if (area < 0)
+	{
+		RasterVert tv = b; b = c; c = tv;
+		int64_t t;
+		t = bx; bx = cx; cx = t;
+		t = by; by = cy; cy = t;
+		area = -area;
+	}
 
-	int minX = (int)fmaxf(0.0f, floorf(fminf(a.x, fminf(b.x, c.x))));
-	int maxX = (int)fminf(FB_WIDTH - 1.0f, ceilf(fmaxf(a.x, fmaxf(b.x, c.x))));
-	int minY = (int)fmaxf(0.0f, floorf(fminf(a.y, fminf(b.y, c.y))));
-	int maxY = (int)fminf(FB_HEIGHT - 1.0f, ceilf(fmaxf(a.y, fmaxf(b.y, c.y))));
+	int64_t min_x = ax < bx ? (ax < cx ? ax : cx) : (bx < cx ? bx : cx);
+	int64_t max_x = ax > bx ? (ax > cx ? ax : cx) : (bx > cx ? bx : cx);
+	int64_t min_y = ay < by ? (ay < cy ? ay : cy) : (by < cy ? by : cy);
+	int64_t max_y = ay > by ? (ay > cy ? ay : cy) : (by > cy ? by : cy);
 
-	if (!mesh->pixels || mesh->tex_width == 0 || mesh->tex_height == 0) {
-		if (debug_log) {
-			fprintf(debug_log, "Invalid texture! Skipping mesh\n");
-			fflush(debug_log);
+	// Pixels whose centre (x * 16 + 8) can fall inside the triangle
+	int64_t px0 = subpixel_ceil(min_x - SUBPIXEL_HALF);
+	int64_t px1 = subpixel_floor(max_x - SUBPIXEL_HALF);
+	int64_t py0 = subpixel_ceil(min_y - SUBPIXEL_HALF);
+	int64_t py1 = subpixel_floor(max_y - SUBPIXEL_HALF);
+
+	if (px0 < 0) px0 = 0;
+	if (py0 < 0) py0 = 0;
+	if (px1 > FB_WIDTH - 1) px1 = FB_WIDTH - 1;
+	if (py1 > FB_HEIGHT - 1) py1 = FB_HEIGHT - 1;
+
+	if (px0 > px1 || py0 > py1) return false;
+
+	tri->minX = (int)px0;
+	tri->maxX = (int)px1;
+	tri->minY = (int)py0;
+	tri->maxY = (int)py1;
+
+	setup_edge(&tri->edges[0], bx, by, cx, cy);
+	setup_edge(&tri->edges[1], cx, cy, ax, ay);
+	setup_edge(&tri->edges[2], ax, ay, bx, by);
+
+	// Edge functions are linear, so their extremes over the box are at its corners
+	tri->fits32 = true;
+	for (int i = 0; i < 3; i++)
+	{
+		const RasterEdge* e = &tri->edges[i];
+		int64_t corners[4] = {
+			edge_at(e, tri->minX, tri->minY), edge_at(e, tri->maxX, tri->minY),
+			edge_at(e, tri->minX, tri->maxY), edge_at(e, tri->maxX, tri->maxY)
+		};
+
+		for (int k = 0; k < 4; k++)
+		{
+			if (corners[k] > INT32_MAX || corners[k] < -INT32_MAX)
+				tri->fits32 = false;
 		}
-		return;
 	}
 
-	for (int y = minY; y <= maxY; y++)
-	for (int x = minX; x <= maxX; x++)
+	tri->a = a;
+	tri->b = b;
+	tri->c = c;
+	tri->inv_area = 1.0f / (float)area;
+
+	// Screen-space depth is affine, so no covered pixel is nearer than the nearest vertex
+	float zmin = fminf(a.z_over_w, fminf(b.z_over_w, c.z_over_w));
+	tri->zmin = (0.5f * zmin + 0.5f) - HIZ_BIAS;
+	tri->pixels = texture->pixels;
+	tri->tex_width = texture->width;
+	tri->tex_height = texture->height;
+	tri->wrap = texture->wrap;
+	tri->light = light;
+
+	return true;
+}
+
+/* Every float at or beyond 2^23 is an integer, so clamping there keeps the
+ * integer conversions used by the SIMD floor in range without changing results.
+ */
+#define WRAP_LIMIT 8388608.0f
+
+/* Fractional part of a repeating texture coordinate, in [0, 1] */
+static inline float wrap_unit(float u)
+{
+	u = fminf(fmaxf(u, -WRAP_LIMIT), WRAP_LIMIT);
+	return u - floorf(u);
+}
+
+/* Shade one covered pixel of `tri` from its edge values scaled by 1/area.
+ * This is the reference implementation: the SIMD span kernels below evaluate
+ * exactly the same float expressions in the same order (no FMA contraction),
+ * so every path produces identical pixels.
+ */
+static inline void shade_pixel(const RasterTri* tri, int idx, float w0, float w1, float w2)
+{
+	const RasterVert* a = &tri->a;
+	const RasterVert* b = &tri->b;
+	const RasterVert* c = &tri->c;
+
+	// Interpolate depth (already perspective-corrected)
+	float z = a->z_over_w * w0 + b->z_over_w * w1 + c->z_over_w * w2;
+
+	// Map from [-1, 1] to [0, 1] for depth buffer
+	z = 0.5f * z + 0.5f;
+
+	if (z >= depthbuffer[idx]) return;
+	depthbuffer[idx] = z;
+
+	// Perspective-correct interpolation for UVs
+	float inv_w =
+		a->inv_w * w0 +
+		b->inv_w * w1 +
+		c->inv_w * w2;
+
+	if (inv_w <= 0.0f) return;
+
+	float w = 1.0f / inv_w;
+
+	float u =
+		(a->u_over_w * w0 +
+		 b->u_over_w * w1 +
+		 c->u_over_w * w2) * w;
+
+	float v =
+		(a->v_over_w * w0 +
+		 b->v_over_w * w1 +
+		 c->v_over_w * w2) * w;
+
+	if (tri->wrap)
+	{
+		u = wrap_unit(u);
+		v = wrap_unit(v);
+	}
+
+	u = fminf(fmaxf(u, 0.0f), 1.0f);
+	v = fminf(fmaxf(v, 0.0f), 1.0f);
+
+	int tx = (int)(u * (tri->tex_width  - 1));
+	int ty = (int)(v * (tri->tex_height - 1));
+
+	if (!show_uvs)
 	{
-		float px = x + 0.5f;
-		float py = y + 0.5f;
+		uint32_t tex = tri->pixels[ty * tri->tex_width + tx];
 
-		float w0 = edge(b.x, b.y, c.x, c.y, px, py) / area;
-		float w1 = edge(c.x, c.y, a.x, a.y, px, py) / area;
-		float w2 = 1.0f - w0 - w1;
+		uint8_t r = (tex >> 16) & 0xFF;
+		uint8_t g = (tex >> 8) & 0xFF;
+		uint8_t b = tex & 0xFF;
 
-		if (w0 < 0 || w1 < 0 || w2 < 0)
-			continue;
+		r = (uint8_t)(r * tri->light);
+		g = (uint8_t)(g * tri->light);
+		b = (uint8_t)(b * tri->light);
 
-		// Interpolate depth (already perspective-corrected)
-		float z = a.z_over_w * w0 + b.z_over_w * w1 + c.z_over_w * w2;
+		framebuffer_game[idx] = (0xFF << 24) | (r << 16) | (g << 8) | b;
+	}
+	else
+	{
+		uint8_t ru = (uint8_t)(u * 255);
+		uint8_t gv = (uint8_t)(v * 255);
+		uint32_t color = (ru << 16) | (gv << 8) | 0xFF;
+		framebuffer_game[idx] = color;
+	}
+}
 
-		// Map from [-1, 1] to [0, 1] for depth buffer
-		z = 0.5f * z + 0.5f;
+/* =================================
+ * SIMD span kernels
+ *
+ * A span kernel shades whole vectors of pixels of row `y` starting at `x`
+ * while the vector fits inside [x, maxX], and returns the first pixel it did
+ * not handle; the caller finishes the row with `shade_pixel`. Vectors never
+ * extend past maxX, so the kernels stay inside the caller's rectangle.
+ * e0..e2 are the edge values at (x, y); kernels only run on triangles whose
+ * edge values fit in 32 bits (`fits32`).
+  ================================== */
+typedef int (*SpanKernel)(const RasterTri* tri, int y, int x, int maxX, int32_t e0, int32_t e1, int32_t e2);
 
-		int idx = y * FB_WIDTH + x;
-		if (z >= depthbuffer[idx]) continue;
-		depthbuffer[idx] = z;
+static SpanKernel span_kernel = NULL;
+static bool span_kernel_selected = false;
+static bool simd_enabled = true;
 
-		// Perspective-correct interpolation for UVs
-		float inv_w = 
-			a.inv_w * w0 +
-			b.inv_w * w1 +
-			c.inv_w * w2;
+#ifdef SKETCH_X86_SIMD
 
-		if (inv_w <= 0.0f) continue;
+/* Per-lane offsets { 0, s, 2s, ... } of an edge stepping by s per pixel; the
+ * arithmetic wraps like the vector adds do, which is harmless because lanes
+ * outside the bounding box are never used.
+ */
+static inline int32_t lane_offset(const RasterEdge* e, int lane)
+{
+	return (int32_t)(uint32_t)(uint64_t)(e->a * SUBPIXEL_ONE * lane);
+}
+
+__attribute__((target("sse2")))
+static inline __m128 wrap_unit_sse2(__m128 u)
+{
+	const __m128 limit = _mm_set1_ps(WRAP_LIMIT);
+	u = _mm_min_ps(_mm_max_ps(u, _mm_sub_ps(_mm_setzero_ps(), limit)), limit);
+
+	// floor: truncate, then step down where truncation rounded up
+	__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(u));
+	t = _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, u), _mm_set1_ps(1.0f)));
+
+	return _mm_sub_ps(u, t);
+}
+
+__attribute__((target("sse2")))
+static int draw_span_sse2(const RasterTri* tri, int y, int x, int maxX, int32_t e0, int32_t e1, int32_t e2)
+{
+	const RasterVert* a = &tri->a;
+	const RasterVert* b = &tri->b;
+	const RasterVert* c = &tri->c;
+	const RasterEdge* edges = tri->edges;
+
+	__m128i E0 = _mm_add_epi32(_mm_set1_epi32(e0),
+		_mm_setr_epi32(0, lane_offset(&edges[0], 1), lane_offset(&edges[0], 2), lane_offset(&edges[0], 3)));
+	__m128i E1 = _mm_add_epi32(_mm_set1_epi32(e1),
+		_mm_setr_epi32(0, lane_offset(&edges[1], 1), lane_offset(&edges[1], 2), lane_offset(&edges[1], 3)));
+	__m128i E2 = _mm_add_epi32(_mm_set1_epi32(e2),
+		_mm_setr_epi32(0, lane_offset(&edges[2], 1), lane_offset(&edges[2], 2), lane_offset(&edges[2], 3)));
+
+	const __m128i step0 = _mm_set1_epi32(lane_offset(&edges[0], 4));
+	const __m128i step1 = _mm_set1_epi32(lane_offset(&edges[1], 4));
+	const __m128i step2 = _mm_set1_epi32(lane_offset(&edges[2], 4));
+
+	const __m128i t0 = _mm_set1_epi32((int32_t)edges[0].threshold);
+	const __m128i t1 = _mm_set1_epi32((int32_t)edges[1].threshold);
+	const __m128i t2 = _mm_set1_epi32((int32_t)edges[2].threshold);
+
+	const __m128 inv_area = _mm_set1_ps(tri->inv_area);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one  = _mm_set1_ps(1.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	const __m128 za = _mm_set1_ps(a->z_over_w), zb = _mm_set1_ps(b->z_over_w), zc = _mm_set1_ps(c->z_over_w);
+	const __m128 wa = _mm_set1_ps(a->inv_w),    wb = _mm_set1_ps(b->inv_w),    wc = _mm_set1_ps(c->inv_w);
+	const __m128 ua = _mm_set1_ps(a->u_over_w), ub = _mm_set1_ps(b->u_over_w), uc = _mm_set1_ps(c->u_over_w);
+	const __m128 va = _mm_set1_ps(a->v_over_w), vb = _mm_set1_ps(b->v_over_w), vc = _mm_set1_ps(c->v_over_w);
+
+	const __m128 tex_w = _mm_set1_ps((float)(tri->tex_width - 1));
+	const __m128 tex_h = _mm_set1_ps((float)(tri->tex_height - 1));
+	const __m128 light = _mm_set1_ps(tri->light);
+	const __m128 scale255 = _mm_set1_ps(255.0f);
+	const __m128i mask8 = _mm_set1_epi32(0xFF);
+
+	float* depth_row = &depthbuffer[y * FB_WIDTH];
+	uint32_t* color_row = &framebuffer_game[y * FB_WIDTH];
+
+	for (; x + 3 <= maxX; x += 4,
+		E0 = _mm_add_epi32(E0, step0), E1 = _mm_add_epi32(E1, step1), E2 = _mm_add_epi32(E2, step2))
+	{
+		__m128 inside = _mm_castsi128_ps(_mm_and_si128(_mm_cmpgt_epi32(E0, t0),
+		                _mm_and_si128(_mm_cmpgt_epi32(E1, t1), _mm_cmpgt_epi32(E2, t2))));
+		if (_mm_movemask_ps(inside) == 0) continue;
 
-		float u =
-			(a.u_over_w * w0 +
-			 b.u_over_w * w1 +
-			 c.u_over_w * w2) / inv_w;
+		__m128 w0 = _mm_mul_ps(_mm_cvtepi32_ps(E0), inv_area);
+		__m128 w1 = _mm_mul_ps(_mm_cvtepi32_ps(E1), inv_area);
+		__m128 w2 = _mm_mul_ps(_mm_cvtepi32_ps(E2), inv_area);
 
-		float v =
-			(a.v_over_w * w0 +
-			 b.v_over_w * w1 +
-			 c.v_over_w * w2) / inv_w;
+		__m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(za, w0), _mm_mul_ps(zb, w1)), _mm_mul_ps(zc, w2));
+		z = _mm_add_ps(_mm_mul_ps(half, z), half);
 
-		u = fminf(fmaxf(u, 0.0f), 1.0f);
-		v = fminf(fmaxf(v, 0.0f), 1.0f);
+		__m128 depth = _mm_loadu_ps(&depth_row[x]);
+		__m128 pass = _mm_and_ps(inside, _mm_cmpnge_ps(z, depth));
+		if (_mm_movemask_ps(pass) == 0) continue;
 
-		int tx = (int)(u * (mesh->tex_width  - 1));
-		int ty = (int)(v * (mesh->tex_height - 1));
+		_mm_storeu_ps(&depth_row[x], _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, depth)));
 
+		__m128 inv_w = _mm_add_ps(_mm_add_ps(_mm_mul_ps(wa, w0), _mm_mul_ps(wb, w1)), _mm_mul_ps(wc, w2));
+		__m128 shade = _mm_and_ps(pass, _mm_cmpnle_ps(inv_w, zero));
+		int shade_bits = _mm_movemask_ps(shade);
+		if (shade_bits == 0) continue;
+
+		__m128 w = _mm_div_ps(one, inv_w);
+		__m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ua, w0), _mm_mul_ps(ub, w1)), _mm_mul_ps(uc, w2)), w);
+		__m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(va, w0), _mm_mul_ps(vb, w1)), _mm_mul_ps(vc, w2)), w);
+
+		if (tri->wrap)
+		{
+			u = wrap_unit_sse2(u);
+			v = wrap_unit_sse2(v);
+		}
+
+		u = _mm_min_ps(_mm_max_ps(u, zero), one);
+		v = _mm_min_ps(_mm_max_ps(v, zero), one);
+
+		__m128i color;
 		if (!show_uvs)
 		{
-			uint32_t tex = mesh->pixels[ty * mesh->tex_width + tx];
+			__m128i tx = _mm_cvttps_epi32(_mm_mul_ps(u, tex_w));
+			__m128i ty = _mm_cvttps_epi32(_mm_mul_ps(v, tex_h));
+
+			int32_t tx_lane[4], ty_lane[4];
+			uint32_t texel[4] = { 0, 0, 0, 0 };
+			_mm_storeu_si128((__m128i*)tx_lane, tx);
+			_mm_storeu_si128((__m128i*)ty_lane, ty);
+
+			for (int i = 0; i < 4; i++)
+			{
+				if (shade_bits & (1 << i))
+					texel[i] = tri->pixels[ty_lane[i] * tri->tex_width + tx_lane[i]];
+			}
+
+			__m128i tex = _mm_loadu_si128((const __m128i*)texel);
+			__m128i r = _mm_and_si128(_mm_srli_epi32(tex, 16), mask8);
+			__m128i g = _mm_and_si128(_mm_srli_epi32(tex, 8), mask8);
+			__m128i bl = _mm_and_si128(tex, mask8);
+
+			r = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(r), light));
+			g = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(g), light));
+			bl = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(bl), light));
+
+			color = _mm_or_si128(_mm_set1_epi32((int)0xFF000000),
+			        _mm_or_si128(_mm_slli_epi32(_mm_and_si128(r, mask8), 16),
+			        _mm_or_si128(_mm_slli_epi32(_mm_and_si128(g, mask8), 8), _mm_and_si128(bl, mask8))));
+		}
+		else
+		{
+			__m128i ru = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(u, scale255)), mask8);
+			__m128i gv = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(v, scale255)), mask8);
+			color = _mm_or_si128(_mm_slli_epi32(ru, 16), _mm_or_si128(_mm_slli_epi32(gv, 8), mask8));
+		}
+
+		__m128i keep = _mm_castps_si128(shade);
+		__m128i old = _mm_loadu_si128((const __m128i*)&color_row[x]);
+		_mm_storeu_si128((__m128i*)&color_row[x],
+			_mm_or_si128(_mm_and_si128(keep, color), _mm_andnot_si128(keep, old)));
+	}
+
+	return x;
+}
+
+__attribute__((target("avx2")))
+static int draw_span_avx2(const RasterTri* tri, int y, int x, int maxX, int32_t e0, int32_t e1, int32_t e2)
+{
+	const RasterVert* a = &tri->a;
+	const RasterVert* b = &tri->b;
+	const RasterVert* c = &tri->c;
+	const RasterEdge* edges = tri->edges;
+
+	const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+	__m256i E0 = _mm256_add_epi32(_mm256_set1_epi32(e0), _mm256_mullo_epi32(lane, _mm256_set1_epi32(lane_offset(&edges[0], 1))));
+	__m256i E1 = _mm256_add_epi32(_mm256_set1_epi32(e1), _mm256_mullo_epi32(lane, _mm256_set1_epi32(lane_offset(&edges[1], 1))));
+	__m256i E2 = _mm256_add_epi32(_mm256_set1_epi32(e2), _mm256_mullo_epi32(lane, _mm256_set1_epi32(lane_offset(&edges[2], 1))));
+
+	const __m256i step0 = _mm256_set1_epi32(lane_offset(&edges[0], 8));
+	const __m256i step1 = _mm256_set1_epi32(lane_offset(&edges[1], 8));
+	const __m256i step2 = _mm256_set1_epi32(lane_offset(&edges[2], 8));
+
+	const __m256i t0 = _mm256_set1_epi32((int32_t)edges[0].threshold);
+	const __m256i t1 = _mm256_set1_epi32((int32_t)edges[1].threshold);
+	const __m256i t2 = _mm256_set1_epi32((int32_t)edges[2].threshold);
+
+	const __m256 inv_area = _mm256_set1_ps(tri->inv_area);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one  = _mm256_set1_ps(1.0f);
+	const __m256 half = _mm256_set1_ps(0.5f);
+
+	const __m256 za = _mm256_set1_ps(a->z_over_w), zb = _mm256_set1_ps(b->z_over_w), zc = _mm256_set1_ps(c->z_over_w);
+	const __m256 wa = _mm256_set1_ps(a->inv_w),    wb = _mm256_set1_ps(b->inv_w),    wc = _mm256_set1_ps(c->inv_w);
+	const __m256 ua = _mm256_set1_ps(a->u_over_w), ub = _mm256_set1_ps(b->u_over_w), uc = _mm256_set1_ps(c->u_over_w);
+	const __m256 va = _mm256_set1_ps(a->v_over_w), vb = _mm256_set1_ps(b->v_over_w), vc = _mm256_set1_ps(c->v_over_w);
+
+	const __m256 tex_w = _mm256_set1_ps((float)(tri->tex_width - 1));
+	const __m256 tex_h = _mm256_set1_ps((float)(tri->tex_height - 1));
+	const __m256i tex_stride = _mm256_set1_epi32(tri->tex_width);
+	const __m256 light = _mm256_set1_ps(tri->light);
+	const __m256 scale255 = _mm256_set1_ps(255.0f);
+	const __m256i mask8 = _mm256_set1_epi32(0xFF);
+
+	float* depth_row = &depthbuffer[y * FB_WIDTH];
+	uint32_t* color_row = &framebuffer_game[y * FB_WIDTH];
+
+	for (; x + 7 <= maxX; x += 8,
+		E0 = _mm256_add_epi32(E0, step0), E1 = _mm256_add_epi32(E1, step1), E2 = _mm256_add_epi32(E2, step2))
+	{
+		__m256 inside = _mm256_castsi256_ps(_mm256_and_si256(_mm256_cmpgt_epi32(E0, t0),
+		                _mm256_and_si256(_mm256_cmpgt_epi32(E1, t1), _mm256_cmpgt_epi32(E2, t2))));
+		if (_mm256_movemask_ps(inside) == 0) continue;
+
+		__m256 w0 = _mm256_mul_ps(_mm256_cvtepi32_ps(E0), inv_area);
+		__m256 w1 = _mm256_mul_ps(_mm256_cvtepi32_ps(E1), inv_area);
+		__m256 w2 = _mm256_mul_ps(_mm256_cvtepi32_ps(E2), inv_area);
+
+		__m256 z = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(za, w0), _mm256_mul_ps(zb, w1)), _mm256_mul_ps(zc, w2));
+		z = _mm256_add_ps(_mm256_mul_ps(half, z), half);
 
-			uint8_t r = (tex >> 16) & 0xFF;
-			uint8_t g = (tex >> 8) & 0xFF;
-			uint8_t b = tex & 0xFF;
+		__m256 depth = _mm256_loadu_ps(&depth_row[x]);
+		__m256 pass = _mm256_and_ps(inside, _mm256_cmp_ps(z, depth, _CMP_NGE_UQ));
+		if (_mm256_movemask_ps(pass) == 0) continue;
 
-			r = (uint8_t)(r * light);
-			g = (uint8_t)(g * light);
-			b = (uint8_t)(b * light);
+		_mm256_storeu_ps(&depth_row[x], _mm256_blendv_ps(depth, z, pass));
 
-			framebuffer_game[idx] = (0xFF << 24) | (r << 16) | (g << 8) | b;
+		__m256 inv_w = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(wa, w0), _mm256_mul_ps(wb, w1)), _mm256_mul_ps(wc, w2));
+		__m256 shade = _mm256_and_ps(pass, _mm256_cmp_ps(inv_w, zero, _CMP_NLE_UQ));
+		if (_mm256_movemask_ps(shade) == 0) continue;
+
+		__m256 w = _mm256_div_ps(one, inv_w);
+		__m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ua, w0), _mm256_mul_ps(ub, w1)), _mm256_mul_ps(uc, w2)), w);
+		__m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(va, w0), _mm256_mul_ps(vb, w1)), _mm256_mul_ps(vc, w2)), w);
+
+		if (tri->wrap)
+		{
+			const __m256 limit = _mm256_set1_ps(WRAP_LIMIT);
+			u = _mm256_min_ps(_mm256_max_ps(u, _mm256_sub_ps(zero, limit)), limit);
+			v = _mm256_min_ps(_mm256_max_ps(v, _mm256_sub_ps(zero, limit)), limit);
+			u = _mm256_sub_ps(u, _mm256_floor_ps(u));
+			v = _mm256_sub_ps(v, _mm256_floor_ps(v));
+		}
+
+		u = _mm256_min_ps(_mm256_max_ps(u, zero), one);
+		v = _mm256_min_ps(_mm256_max_ps(v, zero), one);
+
+		__m256i keep = _mm256_castps_si256(shade);
+		__m256i color;
+		if (!show_uvs)
+		{
+			__m256i tx = _mm256_cvttps_epi32(_mm256_mul_ps(u, tex_w));
+			__m256i ty = _mm256_cvttps_epi32(_mm256_mul_ps(v, tex_h));
+			__m256i offset = _mm256_add_epi32(_mm256_mullo_epi32(ty, tex_stride), tx);
+
+			__m256i tex = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(),
+				(const int*)tri->pixels, offset, keep, 4);
+
+			__m256i r = _mm256_and_si256(_mm256_srli_epi32(tex, 16), mask8);
+			__m256i g = _mm256_and_si256(_mm256_srli_epi32(tex, 8), mask8);
+			__m256i bl = _mm256_and_si256(tex, mask8);
+
+			r = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(r), light));
+			g = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(g), light));
+			bl = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(bl), light));
+
+			color = _mm256_or_si256(_mm256_set1_epi32((int)0xFF000000),
+			        _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(r, mask8), 16),
+			        _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(g, mask8), 8), _mm256_and_si256(bl, mask8))));
 		}
 		else
 		{
-			uint8_t ru = (uint8_t)(u * 255);
-			uint8_t gv = (uint8_t)(v * 255);
-			uint32_t color = (ru << 16) | (gv << 8) | 0xFF;
-			framebuffer_game[idx] = color;
+			__m256i ru = _mm256_and_si256(_mm256_cvttps_epi32(_mm256_mul_ps(u, scale255)), mask8);
+			__m256i gv = _mm256_and_si256(_mm256_cvttps_epi32(_mm256_mul_ps(v, scale255)), mask8);
+			color = _mm256_or_si256(_mm256_slli_epi32(ru, 16), _mm256_or_si256(_mm256_slli_epi32(gv, 8), mask8));
+		}
+
+		_mm256_maskstore_epi32((int*)&color_row[x], keep, color);
+	}
+
+	return x;
+}
+
+#endif // SKETCH_X86_SIMD
+
+static void select_span_kernel(void)
+{
+	span_kernel = NULL;
+	span_kernel_selected = true;
+
+	if (!simd_enabled) return;
+
+#ifdef SKETCH_X86_SIMD
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx2"))
+		span_kernel = draw_span_avx2;
+	else if (__builtin_cpu_supports("sse2"))
+		span_kernel = draw_span_sse2;
+#endif
+}
+
+void sketch_set_simd(bool enabled)
+{
+	// Queued triangles must not change kernels halfway through a frame
+	sketch_flush();
+
+	simd_enabled = enabled;
+	select_span_kernel();
+}
+
+static float hiz_block_max(int block)
+{
+	if (hiz_dirty[block])
+	{
+		int bx = (block % HIZ_COLS) * HIZ_SIZE;
+		int by = (block / HIZ_COLS) * HIZ_SIZE;
+
+		// Column-wise maxima first: element-wise, so the compiler can vectorize it
+		float col[HIZ_SIZE];
+		for (int x = 0; x < HIZ_SIZE; x++)
+			col[x] = 0.0f;
+
+		for (int y = 0; y < HIZ_SIZE; y++)
+		{
+			const float* row = &depthbuffer[(by + y) * FB_WIDTH + bx];
+			for (int x = 0; x < HIZ_SIZE; x++)
+				col[x] = row[x] > col[x] ? row[x] : col[x];
 		}
+
+		float max = col[0];
+		for (int x = 1; x < HIZ_SIZE; x++)
+			max = col[x] > max ? col[x] : max;
+
+		hiz_max[block] = max;
+		hiz_dirty[block] = false;
 	}
+
+	return hiz_max[block];
+}
+
+/* Rasterize `tri` inside the inclusive pixel rectangle [minX, maxX] x [minY, maxY],
+ * which must already lie within the triangle's bounding box.
+ */
+static void draw_rect(const RasterTri* tri, int minX, int minY, int maxX, int maxY)
+{
+	const RasterEdge* edges = tri->edges;
+	const float inv_area = tri->inv_area;
+
+	int64_t row0 = edge_at(&edges[0], minX, minY);
+	int64_t row1 = edge_at(&edges[1], minX, minY);
+	int64_t row2 = edge_at(&edges[2], minX, minY);
+
+	const int64_t dx0 = edges[0].a * SUBPIXEL_ONE, dy0 = edges[0].b * SUBPIXEL_ONE;
+	const int64_t dx1 = edges[1].a * SUBPIXEL_ONE, dy1 = edges[1].b * SUBPIXEL_ONE;
+	const int64_t dx2 = edges[2].a * SUBPIXEL_ONE, dy2 = edges[2].b * SUBPIXEL_ONE;
+
+	const int64_t t0 = edges[0].threshold;
+	const int64_t t1 = edges[1].threshold;
+	const int64_t t2 = edges[2].threshold;
+
+	SpanKernel kernel = tri->fits32 ? span_kernel : NULL;
+
+	for (int y = minY; y <= maxY; y++, row0 += dy0, row1 += dy1, row2 += dy2)
+	{
+		int64_t e0 = row0, e1 = row1, e2 = row2;
+		int x = minX;
+
+		if (kernel)
+		{
+			x = kernel(tri, y, x, maxX, (int32_t)e0, (int32_t)e1, (int32_t)e2);
+			e0 += (x - minX) * dx0;
+			e1 += (x - minX) * dx1;
+			e2 += (x - minX) * dx2;
+		}
+
+		for (; x <= maxX; x++, e0 += dx0, e1 += dx1, e2 += dx2)
+		{
+			if (e0 > t0 && e1 > t1 && e2 > t2)
+				shade_pixel(tri, y * FB_WIDTH + x, (float)e0 * inv_area, (float)e1 * inv_area, (float)e2 * inv_area);
+		}
+	}
+}
+
+/* Rasterize the part of `tri` that falls inside the inclusive pixel rectangle
+ * [x0, x1] x [y0, y1]. Only pixels inside that rectangle are read or written.
+ * Depth blocks the triangle cannot pass are skipped, and consecutive blocks
+ * that survive are drawn as one rectangle so the span kernels keep long rows.
+ */
+static void draw_triangle(const RasterTri* tri, int x0, int y0, int x1, int y1)
+{
+	int minX = tri->minX > x0 ? tri->minX : x0;
+	int maxX = tri->maxX < x1 ? tri->maxX : x1;
+	int minY = tri->minY > y0 ? tri->minY : y0;
+	int maxY = tri->maxY < y1 ? tri->maxY : y1;
+
+	if (minX > maxX || minY > maxY) return;
+
+	int bx0 = minX / HIZ_SIZE, bx1 = maxX / HIZ_SIZE;
+	int by0 = minY / HIZ_SIZE, by1 = maxY / HIZ_SIZE;
+
+	for (int by = by0; by <= by1; by++)
+	{
+		int ry0 = by * HIZ_SIZE > minY ? by * HIZ_SIZE : minY;
+		int ry1 = by * HIZ_SIZE + HIZ_SIZE - 1 < maxY ? by * HIZ_SIZE + HIZ_SIZE - 1 : maxY;
+
+		int bx = bx0;
+		while (bx <= bx1)
+		{
+			if (tri->zmin >= hiz_block_max(by * HIZ_COLS + bx))
+			{
+				bx++;
+				continue;
+			}
+
+			int run = bx;
+			while (bx <= bx1 && tri->zmin < hiz_block_max(by * HIZ_COLS + bx))
+				bx++;
+
+			int rx0 = run * HIZ_SIZE > minX ? run * HIZ_SIZE : minX;
+			int rx1 = bx * HIZ_SIZE - 1 < maxX ? bx * HIZ_SIZE - 1 : maxX;
+			draw_rect(tri, rx0, ry0, rx1, ry1);
+
+			for (int i = run; i < bx; i++)
+				hiz_dirty[by * HIZ_COLS + i] = true;
+		}
+	}
+}
+
+static bool bin_reserve(RasterBin* bin)
+{
+	if (bin->count < bin->capacity) return true;
+
+	uint32_t capacity = bin->capacity ? bin->capacity * 2 : 256;
+	uint32_t* tris = realloc(bin->tris, capacity * sizeof(uint32_t));
+	if (!tris) return false;
+
+	bin->tris = tris;
+	bin->capacity = capacity;
+	return true;
+}
+
+/* Queue a set-up triangle into every tile its bounding box touches. Returns
+ * false (leaving the queue untouched) if memory for it could not be reserved.
+ */
+static bool bin_triangle(const RasterTri* tri)
+{
+	if (tri_count == tri_capacity)
+	{
+		uint32_t capacity = tri_capacity ? tri_capacity * 2 : 4096;
+		RasterTri* queue = realloc(tri_queue, capacity * sizeof(RasterTri));
+		if (!queue) return false;
+
+		tri_queue = queue;
+		tri_capacity = capacity;
+	}
+
+	int bx0 = tri->minX / BIN_SIZE, bx1 = tri->maxX / BIN_SIZE;
+	int by0 = tri->minY / BIN_SIZE, by1 = tri->maxY / BIN_SIZE;
+
+	for (int by = by0; by <= by1; by++)
+	for (int bx = bx0; bx <= bx1; bx++)
+	{
+		if (!bin_reserve(&bins[by * BIN_COLS + bx])) return false;
+	}
+
+	uint32_t index = tri_count++;
+	tri_queue[index] = *tri;
+
+	for (int by = by0; by <= by1; by++)
+	for (int bx = bx0; bx <= bx1; bx++)
+	{
+		RasterBin* bin = &bins[by * BIN_COLS + bx];
+		bin->tris[bin->count++] = index;
+	}
+
+	return true;
+}
+
+static void submit_triangle(const RasterTri* tri)
+{
+	if (binned)
+	{
+		if (bin_triangle(tri)) return;
+
+		// Out of memory: keep ordering intact by draining the queue first
+		sketch_flush();
+	}
+
+	draw_triangle(tri, 0, 0, FB_WIDTH - 1, FB_HEIGHT - 1);
+}
+
+static void raster_bin_job(void* user, uint32_t index)
+{
+	(void)user;
+
+	RasterBin* bin = &bins[index];
+	if (bin->count == 0) return;
+
+	int x0 = (int)(index % BIN_COLS) * BIN_SIZE;
+	int y0 = (int)(index / BIN_COLS) * BIN_SIZE;
+	int x1 = x0 + BIN_SIZE - 1;
+	int y1 = y0 + BIN_SIZE - 1;
+	if (x1 > FB_WIDTH - 1) x1 = FB_WIDTH - 1;
+	if (y1 > FB_HEIGHT - 1) y1 = FB_HEIGHT - 1;
+
+	for (uint32_t i = 0; i < bin->count; i++)
+		draw_triangle(&tri_queue[bin->tris[i]], x0, y0, x1, y1);
+}
+
+void sketch_set_binned(bool enabled)
+{
+	if (binned && !enabled)
+		sketch_flush();
+
+	binned = enabled;
+}
+
+void sketch_flush(void)
+{
+	if (tri_count == 0) return;
+
+	workers_run(raster_bin_job, NULL, BIN_COUNT);
+
+	tri_count = 0;
+	for (int i = 0; i < BIN_COUNT; i++)
+		bins[i].count = 0;
 }
 
 static RasterVert clipvert_to_rastervert(const ClipVert* cv)
@@ -267,8 +1172,23 @@ static RasterVert clipvert_to_rastervert(const ClipVert* cv)
     return r;
 }
 
+/* Project, set up and queue one triangle that lies inside the guard band */
+static void draw_clipped_triangle(const ClipVert* a, const ClipVert* b, const ClipVert* c,
+    const RasterTexture* texture, float light_factor)
+{
+    RasterTri tri;
+    if (setup_triangle(&tri, clipvert_to_rastervert(a), clipvert_to_rastervert(b),
+            clipvert_to_rastervert(c), texture, light_factor))
+        submit_triangle(&tri);
+}
+
 static bool once = false;
 
+static inline bool texture_valid(const RasterTexture* texture)
+{
+    return texture->pixels && texture->width > 0 && texture->height > 0;
+}
+
 void sketch_draw_mesh(const RasterMesh* mesh, Mat4 model, Mat4 view, Mat4 projection)
 {
     if (!debug_log) {
@@ -287,68 +1207,98 @@ void sketch_draw_mesh(const RasterMesh* mesh, Mat4 model, Mat4 view, Mat4 projec
         }
     }
 
-    for (uint32_t i = 0; i < mesh->index_count; i += 3)
-    {
-		Vec3 wp[3];
-		for (int k = 0; k < 3; ++k)
-		{
-			const RasterVertex* rv = &mesh->vertices[mesh->indices[i + k]];
-
-			Vec4 p = { rv->x, rv->y, rv->z, 1.0f };
-			p = mat4_mul_vec4(model, p);
+    if (!span_kernel_selected)
+        select_span_kernel();
 
-			wp[k] = (Vec3){ p.x, p.y, p.z };
-		}
+    const RasterTexture mesh_texture = { mesh->pixels, mesh->tex_width, mesh->tex_height, false };
 
-		Vec3 e1 = vec3_sub(wp[1], wp[0]);
-		Vec3 e2 = vec3_sub(wp[2], wp[0]);
-		Vec3 normal = vec3_cross(e1, e2);
+    if (!mesh->face_textures && !texture_valid(&mesh_texture)) {
+        if (debug_log) {
+            fprintf(debug_log, "Invalid texture! Skipping mesh\n");
+            fflush(debug_log);
+        }
+        return;
+    }
 
-		float light_factor;
+    if (!xform_reserve(mesh->vertex_count)) {
+        if (debug_log) {
+            fprintf(debug_log, "Out of memory for %u vertices! Skipping mesh\n", mesh->vertex_count);
+            fflush(debug_log);
+        }
+        return;
+    }
 
-		float len_sq = normal.x * normal.x + normal.y * normal.y + normal.z * normal.z;
-		if (len_sq < 1e-6f) {
-			light_factor = sun.ambient;
-		}
-		else
-		{
-			normal = vec3_normalize(normal);
+    // 1) Transform every vertex once
+    Mat4 mvp = mat4_multiply(mat4_multiply(projection, view), model);
 
-			float ndotl = vec3_dot(normal, vec3_neg(sun.dir));
-			float diffuse = fmaxf(0.0f, ndotl);
+    for (uint32_t v = 0; v < mesh->vertex_count; v++)
+    {
+        const RasterVertex* rv = &mesh->vertices[v];
+        Vec4 p = { rv->x, rv->y, rv->z, 1.0f };
 
-			light_factor = sun.ambient + diffuse * sun.intensity;
-			light_factor = fminf(fmaxf(light_factor, 0.0f), 1.0f);
-		}
+        if (!mesh->face_light) {
+            Vec4 w = mat4_mul_vec4(model, p);
+            xform_world[v] = (Vec3){ w.x, w.y, w.z };
+        }
+        xform_clip[v] = mat4_mul_vec4(mvp, p);
+    }
 
-        // 1) Build three ClipVerts in clip space
+    for (uint32_t i = 0; i < mesh->index_count; i += 3)
+    {
+        // 2) Assemble the triangle from the transformed vertices
         ClipVert in[3];
+        Vec3 wp[3];
         for (int k = 0; k < 3; ++k) {
-            const RasterVertex* rv = &mesh->vertices[mesh->indices[i + k]];
-
-            Vec4 p = { rv->x, rv->y, rv->z, 1.0f };
-            p = mat4_mul_vec4(model, p);
-            p = mat4_mul_vec4(view,  p);
-            p = mat4_mul_vec4(projection, p);  // clip space
+            uint32_t index = mesh->indices[i + k];
+            const RasterVertex* rv = &mesh->vertices[index];
 
-            in[k].p = p;
+            in[k].p = xform_clip[index];
             in[k].u = rv->u;
             in[k].v = rv->v;
+            if (!mesh->face_light)
+                wp[k] = xform_world[index];
         }
 
-        // 2) Clip against near plane
-        ClipTri clipped[2];
-        int tri_count = clip_triangle_near(in, clipped);
-        if (tri_count == 0)
+        // 3) Reject triangles that can never produce a pixel
+        if (cull_triangle(in, mesh->cull))
             continue;
 
-        // 3) For each resulting triangle, convert to RasterVert and draw
-        for (int t = 0; t < tri_count; ++t) {
-            RasterVert a = clipvert_to_rastervert(&clipped[t].v[0]);
-            RasterVert b = clipvert_to_rastervert(&clipped[t].v[1]);
-            RasterVert c = clipvert_to_rastervert(&clipped[t].v[2]);
+        uint32_t face = i / 3;
+
+        const RasterTexture* texture = &mesh_texture;
+        if (mesh->face_textures) {
+            texture = &mesh->textures[mesh->face_textures[face]];
+            if (!texture_valid(texture))
+                continue;
+        }
+
+        float light_factor;
+        if (mesh->face_light)
+            light_factor = mesh->face_light[mesh->face_light_ids ? mesh->face_light_ids[face] : face];
+        else
+            light_factor = directional_light_factor(&sun, directional_light_face_normal(wp[0], wp[1], wp[2]));
+
+        // 4) Clip against near plane
+        ClipTri clipped[2];
+        int clipped_count = clip_triangle_near(in, clipped);
+        if (clipped_count == 0)
+            continue;
 
-            draw_triangle(a, b, c, mesh, light_factor);
+        // 5) For each resulting triangle, convert to RasterVert and draw
+        for (int t = 0; t < clipped_count; ++t) {
+            const ClipVert* v = clipped[t].v;
+
+            // Vertices far off screen (near the camera, mostly) are clipped
+            // to the guard band first, so they can be snapped to fixed point
+            if (clip_in_guard_band(&v[0]) && clip_in_guard_band(&v[1]) && clip_in_guard_band(&v[2])) {
+                draw_clipped_triangle(&v[0], &v[1], &v[2], texture, light_factor);
+                continue;
+            }
+
+            ClipVert polygon[GUARD_MAX_VERTS];
+            int polygon_count = clip_triangle_guard(v, polygon);
+            for (int k = 1; k + 1 < polygon_count; ++k)
+                draw_clipped_triangle(&polygon[0], &polygon[k], &polygon[k + 1], texture, light_factor);
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#ifdef __linux__
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "thread.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <stdlib.h>
+
+struct Thread
+{
+	pthread_t handle;
+	ThreadFunc func;
+	void* user;
+};
+
+struct Mutex
+{
+	pthread_mutex_t handle;
+};
+
+struct CondVar
+{
+	pthread_cond_t handle;
+};
+
+static void* thread_entry(void* arg)
+{
+	Thread* thread = (Thread*)arg;
+	thread->func(thread->user);
+	return NULL;
+}
+
+Thread* thread_create(ThreadFunc func, void* user)
+{
+	Thread* thread = malloc(sizeof(Thread));
+	if (!thread) return NULL;
+
+	thread->func = func;
+	thread->user = user;
+
+	if (pthread_create(&thread->handle, NULL, thread_entry, thread) != 0)
+	{
+		free(thread);
+		return NULL;
+	}
+
+	return thread;
+}
+
+void thread_join(Thread* thread)
+{
+	if (!thread) return;
+
+	pthread_join(thread->handle, NULL);
+	free(thread);
+}
+
+int thread_hardware_concurrency(void)
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (int)count : 1;
+}
+
+Mutex* mutex_create(void)
+{
+	Mutex* mutex = malloc(sizeof(Mutex));
+	if (!mutex) return NULL;
+
+	pthread_mutex_init(&mutex->handle, NULL);
+	return mutex;
+}
+
+void mutex_destroy(Mutex* mutex)
+{
+	if (!mutex) return;
+
+	pthread_mutex_destroy(&mutex->handle);
+	free(mutex);
+}
+
+void mutex_lock(Mutex* mutex)
+{
+	pthread_mutex_lock(&mutex->handle);
+}
+
+void mutex_unlock(Mutex* mutex)
+{
+	pthread_mutex_unlock(&mutex->handle);
+}
+
+CondVar* condvar_create(void)
+{
+	CondVar* cond = malloc(sizeof(CondVar));
+	if (!cond) return NULL;
+
+	pthread_cond_init(&cond->handle, NULL);
+	return cond;
+}
+
+void condvar_destroy(CondVar* cond)
+{
+	if (!cond) return;
+
+	pthread_cond_destroy(&cond->handle);
+	free(cond);
+}
+
+void condvar_wait(CondVar* cond, Mutex* mutex)
+{
+	pthread_cond_wait(&cond->handle, &mutex->handle);
+}
+
+void condvar_signal(CondVar* cond)
+{
+	pthread_cond_signal(&cond->handle);
+}
+
+void condvar_broadcast(CondVar* cond)
+{
+	pthread_cond_broadcast(&cond->handle);
+}
+
+#endif // __linux__
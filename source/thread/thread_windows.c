@@ -0,0 +1,122 @@
+#ifdef _WIN32
+
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600	// SRW locks / condition variables
+#endif
+
+#include "thread.h"
+#include <windows.h>
+#include <stdlib.h>
+
+struct Thread
+{
+	HANDLE handle;
+	ThreadFunc func;
+	void* user;
+};
+
+struct Mutex
+{
+	SRWLOCK handle;
+};
+
+struct CondVar
+{
+	CONDITION_VARIABLE handle;
+};
+
+static DWORD WINAPI thread_entry(LPVOID arg)
+{
+	Thread* thread = (Thread*)arg;
+	thread->func(thread->user);
+	return 0;
+}
+
+Thread* thread_create(ThreadFunc func, void* user)
+{
+	Thread* thread = malloc(sizeof(Thread));
+	if (!thread) return NULL;
+
+	thread->func = func;
+	thread->user = user;
+	thread->handle = CreateThread(NULL, 0, thread_entry, thread, 0, NULL);
+
+	if (!thread->handle)
+	{
+		free(thread);
+		return NULL;
+	}
+
+	return thread;
+}
+
+void thread_join(Thread* thread)
+{
+	if (!thread) return;
+
+	WaitForSingleObject(thread->handle, INFINITE);
+	CloseHandle(thread->handle);
+	free(thread);
+}
+
+int thread_hardware_concurrency(void)
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+Mutex* mutex_create(void)
+{
+	Mutex* mutex = malloc(sizeof(Mutex));
+	if (!mutex) return NULL;
+
+	InitializeSRWLock(&mutex->handle);
+	return mutex;
+}
+
+void mutex_destroy(Mutex* mutex)
+{
+	free(mutex);
+}
+
+void mutex_lock(Mutex* mutex)
+{
+	AcquireSRWLockExclusive(&mutex->handle);
+}
+
+void mutex_unlock(Mutex* mutex)
+{
+	ReleaseSRWLockExclusive(&mutex->handle);
+}
+
+CondVar* condvar_create(void)
+{
+	CondVar* cond = malloc(sizeof(CondVar));
+	if (!cond) return NULL;
+
+	InitializeConditionVariable(&cond->handle);
+	return cond;
+}
+
+void condvar_destroy(CondVar* cond)
+{
+	free(cond);
+}
+
+void condvar_wait(CondVar* cond, Mutex* mutex)
+{
+	SleepConditionVariableSRW(&cond->handle, &mutex->handle, INFINITE, 0);
+}
+
+void condvar_signal(CondVar* cond)
+{
+	WakeConditionVariable(&cond->handle);
+}
+
+void condvar_broadcast(CondVar* cond)
+{
+	WakeAllConditionVariable(&cond->handle);
+}
+
+#endif // _WIN32
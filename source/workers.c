@@ -0,0 +1,151 @@
+/*
+ * workers.c - Shared parallel-for worker pool
+ *
+ * A fixed set of background threads sleeps on a condition variable until
+ * `workers_run` publishes a new batch. Items are claimed through an atomic
+ * counter; the submitting thread works on the batch too and then waits until
+ * every background thread has left it before returning.
+ */
+
+#include "workers.h"
+#include "thread.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+static struct
+{
+	Thread* threads[WORKERS_MAX];
+	int thread_count;
+
+	Mutex* mutex;
+	CondVar* wake;
+	CondVar* done;
+
+	uint32_t generation;
+	int active;
+	bool quit;
+
+	WorkerJob job;
+	void* user;
+	uint32_t count;
+	atomic_uint next;
+} pool;
+
+static void workers_drain(WorkerJob job, void* user, uint32_t count)
+{
+	uint32_t index;
+	while ((index = atomic_fetch_add(&pool.next, 1)) < count)
+	{
+		job(user, index);
+	}
+}
+
+static void worker_main(void* arg)
+{
+	(void)arg;
+	uint32_t seen = 0;
+
+	mutex_lock(pool.mutex);
+	for (;;)
+	{
+		while (!pool.quit && pool.generation == seen)
+			condvar_wait(pool.wake, pool.mutex);
+
+		if (pool.quit)
+			break;
+
+		seen = pool.generation;
+		WorkerJob job = pool.job;
+		void* user = pool.user;
+		uint32_t count = pool.count;
+
+		mutex_unlock(pool.mutex);
+		workers_drain(job, user, count);
+		mutex_lock(pool.mutex);
+
+		if (--pool.active == 0)
+			condvar_signal(pool.done);
+	}
+	mutex_unlock(pool.mutex);
+}
+
+void workers_init(int thread_count)
+{
+	if (thread_count <= 0)
+		thread_count = thread_hardware_concurrency() - 1;
+	if (thread_count > WORKERS_MAX)
+		thread_count = WORKERS_MAX;
+
+	pool.mutex = mutex_create();
+	pool.wake = condvar_create();
+	pool.done = condvar_create();
+	pool.generation = 0;
+	pool.active = 0;
+	pool.quit = false;
+	pool.thread_count = 0;
+
+	for (int i = 0; i < thread_count; i++)
+	{
+		Thread* thread = thread_create(worker_main, NULL);
+		if (!thread) break;
+
+		pool.threads[pool.thread_count++] = thread;
+	}
+}
+
+void workers_run(WorkerJob job, void* user, uint32_t count)
+{
+	if (count == 0) return;
+
+	atomic_store(&pool.next, 0);
+
+	if (pool.thread_count == 0 || count == 1)
+	{
+		workers_drain(job, user, count);
+		return;
+	}
+
+	mutex_lock(pool.mutex);
+	pool.job = job;
+	pool.user = user;
+	pool.count = count;
+	pool.active = pool.thread_count;
+	pool.generation++;
+	condvar_broadcast(pool.wake);
+	mutex_unlock(pool.mutex);
+
+	workers_drain(job, user, count);
+
+	mutex_lock(pool.mutex);
+	while (pool.active > 0)
+		condvar_wait(pool.done, pool.mutex);
+	mutex_unlock(pool.mutex);
+}
+
+int workers_count(void)
+{
+	return pool.thread_count + 1;
+}
+
+void workers_shutdown(void)
+{
+	if (!pool.mutex) return;
+
+	mutex_lock(pool.mutex);
+	pool.quit = true;
+	condvar_broadcast(pool.wake);
+	mutex_unlock(pool.mutex);
+
+	for (int i = 0; i < pool.thread_count; i++)
+		thread_join(pool.threads[i]);
+
+	pool.thread_count = 0;
+
+	condvar_destroy(pool.done);
+	condvar_destroy(pool.wake);
+	mutex_destroy(pool.mutex);
+	pool.done = NULL;
+	pool.wake = NULL;
+	pool.mutex = NULL;
+}
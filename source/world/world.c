@@ -1,5 +1,8 @@
 #include "world/world.h"
+#include "world/world_loader.h"
+#include "maths/frustum.h"
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 /* External globals, loaded from embedded binary blobs.
@@ -9,53 +12,245 @@
 WorldMatrix g_WorldMatrix = {0};
 WorldHeaders g_WorldHeaders = {0};
 
-/* Forward declaration for internal loader function */
-static void world_load_cell(WorldCell* cell, int mx, int my); 
+extern DirectionalLight sun;
+
+static WorldDrawOrder draw_order = WORLD_DRAW_FRONT_TO_BACK;
+
+/* Forward declarations for internal loader functions */
+static void world_load_cell(WorldCell* cell, int mx, int my, WorldLoadJob* job); 
+static void world_unload_cell(WorldCell* cell);
+static void world_stream(World* world, bool async);
+static void world_prepare_job(WorldLoadJob* job);
+static void world_load_job(WorldLoadJob* job);
+
+/* v mod n, for negative v too */
+static inline int world_wrap(int v, int n)
+{
+    int m = v % n;
+    return m < 0 ? m + n : m;
+}
+
+/* Slot of the full-detail cell at offset (dx, dy) from the center */
+static WorldCell* world_cell_at(World* world, int dx, int dy)
+{
+    int n = world->diameter;
+    return &world->cells[world_wrap(world->cy + dy, n) * n + world_wrap(world->cx + dx, n)];
+}
+
+/* Slot of the LOD cell at offset (dx, dy) from the center */
+static WorldLodCell* world_lod_at(World* world, int dx, int dy)
+{
+    int n = world->lod_diameter;
+    return &world->lod[world_wrap(world->cy + dy, n) * n + world_wrap(world->cx + dx, n)];
+}
+
+/* Cell at offset (dx, dy), or NULL while its slot still waits for the loader */
+static WorldCell* world_cell_ready(World* world, int dx, int dy)
+{
+    WorldCell* cell = world_cell_at(world, dx, dy);
+    if (!cell->loaded || cell->world_x != world->cx + dx || cell->world_y != world->cy + dy)
+        return NULL;
+
+    return cell;
+}
+
+/* LOD cell at offset (dx, dy), or NULL if its slot holds another cell */
+static WorldLodCell* world_lod_ready(World* world, int dx, int dy)
+{
+    WorldLodCell* cell = world_lod_at(world, dx, dy);
+    if (!cell->loaded || cell->world_x != world->cx + dx || cell->world_y != world->cy + dy)
+        return NULL;
+
+    return cell;
+}
+
+/* Pack entries of the tileset tables */
+static AssetKind world_tileset_asset(TilesetKind kind)
+{
+    switch (kind)
+    {
+        case TILESET_LOCAL: return ASSET_TILESET_LOCAL;
+        case TILESET_INTERIOR: return ASSET_TILESET_INTERIOR;
+        default: return ASSET_TILESET_REGIONAL;
+    }
+}
+
+/* Label of the read of blob @id of @kind */
+static inline uint32_t world_read_tag(AssetKind kind, uint16_t id)
+{
+    return (uint32_t)kind << 16 | id;
+}
+
+/**
+ * world_plan_read - Add a read of blob @id of @kind to a loader job
+ * @job: Job being prepared.
+ * @kind, @id: Blob to read.
+ *
+ * The buffer is on the heap: tilesets hand it to the cache, and geometry and
+ * collision are packed out of it, so it is freed once the job is parsed.
+ * Streamed cells thus give up in-place maps on purpose: viewing the buffer
+ * would keep 96 KB per resident cell alive, where the packed maps take a few
+ * hundred bytes of the cell's arena. Nothing is planned without a pack:
+ * embedded blobs are already in memory and are still viewed in place.
+ */
+static void world_plan_read(WorldLoadJob* job, AssetKind kind, uint16_t id)
+{
+    AssetLocation where;
+    if (job->batch.count >= WORLD_LOAD_MAX_READS || !asset_locate(kind, id, &where))
+        return;
+
+    void* buffer = malloc(where.size ? where.size : 1);
+    if (!buffer)
+        return;
+
+    job->reads[job->batch.count++] = (AsyncRead){
+        .file   = where.file,
+        .offset = where.offset,
+        .size   = where.size,
+        .buffer = buffer,
+        .tag    = world_read_tag(kind, id),
+    };
+}
+
+/* The read of blob @id of @kind in @job, if it arrived intact; NULL to look the blob up instead */
+static AsyncRead* world_job_read(WorldLoadJob* job, AssetKind kind, uint16_t id)
+{
+    if (!job)
+        return NULL;
+
+    for (int i = 0; i < job->batch.count; i++)
+    {
+        AsyncRead* read = &job->reads[i];
+        if (read->tag != world_read_tag(kind, id) || !read->buffer)
+            continue;
+
+        return read->ok && asset_verify(kind, id, read->buffer, read->size) ? read : NULL;
+    }
+
+    return NULL;
+}
+
+/* @borrow: whether the map is freed before the job's read buffers are */
+static GeometryMap* world_job_geometry(WorldLoadJob* job, uint16_t id, Arena* arena, bool borrow)
+{
+    AsyncRead* read = world_job_read(job, ASSET_GEOMETRY, id);
+    if (!read)
+        return geometry_load(id, arena);
+
+    Blob blob = { read->buffer, read->size };
+    return geometry_parse(&blob, arena, borrow);
+}
+
+static CollisionMap* world_job_collision(WorldLoadJob* job, uint16_t id, Arena* arena)
+{
+    AsyncRead* read = world_job_read(job, ASSET_COLLISION, id);
+    if (!read)
+        return collision_load(id, arena);
+
+    // The read buffer goes with the job, so the cell keeps a packed copy
+    Blob blob = { read->buffer, read->size };
+    return collision_parse(&blob, arena, false);
+}
+
+static Tileset* world_job_tileset(WorldLoadJob* job, TilesetKind kind, uint16_t id)
+{
+    AsyncRead* read = world_job_read(job, world_tileset_asset(kind), id);
+    if (!read)
+        return tileset_acquire(kind, id);
+
+    // The cache takes the buffer over
+    uint8_t* data = read->buffer;
+    read->buffer = NULL;
+    return tileset_acquire_data(kind, id, data, read->size);
+}
+
+/* Free the read buffers of @job that no cell or tileset took over */
+static void world_release_reads(WorldLoadJob* job)
+{
+    for (int i = 0; i < job->batch.count; i++)
+    {
+        free(job->reads[i].buffer);
+        job->reads[i].buffer = NULL;
+    }
+}
 
 /**
- * world_init - Initialize the world grid and load initial 3x3 surrounding cells.
+ * world_init - Initialize the world grid and load the initial window of cells.
  * @world: Pointer to World struct to initialize.
- * @start_x: Center X coordinate.
- * @start_y: Center Y coordinate.
+ * @start_x: Center cell X, in matrix coordinates.
+ * @start_y: Center cell Y, in matrix coordinates.
+ * @radii: Streaming and drawing radii, or NULL for the defaults.
  */
-void world_init(World* world, int start_x, int start_y)
+void world_init(World* world, int start_x, int start_y, const WorldRadii* radii)
 {
     world_matrix_load(&g_WorldMatrix);
     world_headers_load(&g_WorldHeaders);
+    tileset_cache_init();
+
+    WorldRadii r = radii ? *radii : WORLD_RADII_DEFAULT;
+    if (r.load < 0) r.load = 0;
+    if (r.render < 0) r.render = 0;
+    if (r.render > r.load) r.render = r.load;
+    if (r.lod < r.render) r.lod = r.render;
+
+    world->radii = r;
+    world->diameter = 2 * r.load + 1;
+    world->lod_diameter = 2 * r.lod + 1;
+
+    int cell_count = world->diameter * world->diameter;
+    int lod_count = world->lod_diameter * world->lod_diameter;
+
+    // One arena per cell and per baked mesh, plus what one step of the center keeps
+    // alive: slots hold their old cell until the replacement is collected, so a
+    // diagonal step loads 4r+1 cells and 4r+1 LOD meshes next to the ones they
+    // replace, while the loader has one LOD scratch arena out. Bigger jumps grow the pool.
+    int step_count = (4 * r.load + 1) + (4 * r.lod + 1) + 1;
+    arena_pool_init(2 * cell_count + lod_count + step_count);
 
     world->cx = start_x;
     world->cy = start_y; 
 
-    // Load initial 3x3 grid
-    for (int dy = -1; dy <= 1; dy++)
+    world->cells = calloc(cell_count, sizeof(WorldCell));
+    world->lod = calloc(lod_count, sizeof(WorldLodCell));
+    if (!world->cells || !world->lod)
     {
-        for (int dx = -1; dx <= 1; dx++)
-        {
-            WorldCell* cell = &world->cells[dy+1][dx+1];
-            world_load_cell(cell, start_x + dx, start_y + dy);
-        }
+        // Keep the world valid but empty
+        free(world->cells);
+        free(world->lod);
+        world->cells = NULL;
+        world->lod = NULL;
+        world->diameter = 0;
+        world->lod_diameter = 0;
+        return;
     }
+
+    // The first window is loaded up front so the first frame is complete
+    world_stream(world, false);
+    world_loader_init(world_prepare_job, world_load_job);
 }
 
 /**
  * world_unload_cell - Free resources associated with a single world cell.
  * @cell: Pointer to the WorldCell to unload.
  *
- * Frees geometry, collision and any loaded tilesets and clears pointers.
+ * Frees geometry and collision with the cell's arena, releases the shared
+ * tilesets and clears pointers.
  */
 static void world_unload_cell(WorldCell* cell)
 {
-    if (cell->geometry) geometry_free(cell->geometry);
-    if (cell->collision) collision_free(cell->collision);
-    if (cell->regional_tileset) tileset_free(cell->regional_tileset);
-    if (cell->local_tileset) tileset_free(cell->local_tileset);
-    if (cell->interior_tileset) tileset_free(cell->interior_tileset);
+    arena_release(cell->arena);
+    tileset_release(cell->regional_tileset);
+    tileset_release(cell->local_tileset);
+    tileset_release(cell->interior_tileset);
+    chunk_mesh_free(&cell->mesh);
 
+    cell->arena = NULL;
     cell->geometry = NULL; 
     cell->collision = NULL;
     cell->regional_tileset = NULL;
     cell->local_tileset = NULL;
     cell->interior_tileset = NULL;
+    cell->loaded = false;
 }
 
 /**
@@ -63,10 +258,14 @@ static void world_unload_cell(WorldCell* cell)
  * @cell: Pointer to WorldCell to populate.
  * @mx: Matrix X coordinate.
  * @my: Matrix Y coordinate.
+ * @job: Loader job whose reads hold the cell's blobs, or NULL to look them up.
  *
- * Reads header, loads geometry, collision and associated tilesets.
+ * Reads header, loads geometry and collision into a fresh arena (packed out
+ * of the job's read buffers, if any) and acquires the cell's tilesets from the
+ * shared cache. A cell whose header is missing is loaded empty: it draws
+ * nothing and has no collision.
  */
-static void world_load_cell(WorldCell* cell, int mx, int my)
+static void world_load_cell(WorldCell* cell, int mx, int my, WorldLoadJob* job)
 {
     uint16_t header_id = world_matrix_get(&g_WorldMatrix, mx, my);
     const WorldHeader* h = world_headers_get(&g_WorldHeaders, header_id);
@@ -74,26 +273,280 @@ static void world_load_cell(WorldCell* cell, int mx, int my)
     cell->header_id = header_id;
     cell->world_x = mx;
     cell->world_y = my;
-    cell->vertical_offset = h->vertical_offset; 
+    cell->vertical_offset = h ? h->vertical_offset : 0;
+
+    // Baked lazily on first render
+    memset(&cell->mesh, 0, sizeof(cell->mesh));
+    cell->loaded = true;
+
+    if (!h)
+    {
+        cell->arena = NULL;
+        cell->geometry = NULL;
+        cell->collision = NULL;
+        cell->regional_tileset = NULL;
+        cell->local_tileset = NULL;
+        cell->interior_tileset = NULL;
+        return;
+    }
 
-    cell->geometry = geometry_load(h->geometry_id);
-    cell->collision = collision_load(h->collision_id);
+    cell->arena = arena_acquire();
+    cell->geometry = world_job_geometry(job, h->geometry_id, cell->arena, false);
+    cell->collision = world_job_collision(job, h->collision_id, cell->arena);
 
-    cell->regional_tileset = tileset_load_regional(h->regional_tileset_id);
-    cell->local_tileset = tileset_load_regional(h->local_tileset_id);
-    cell->interior_tileset = tileset_load_regional(h->interior_tileset_id);
+    cell->regional_tileset = world_job_tileset(job, TILESET_REGIONAL, h->regional_tileset_id);
+    cell->local_tileset = world_job_tileset(job, TILESET_LOCAL, h->local_tileset_id);
+    cell->interior_tileset = world_job_tileset(job, TILESET_INTERIOR, h->interior_tileset_id);
 }
 
 /**
- * world_update - Update world center based on player position and reload cells as needed.
+ * world_load_lod_cell - Build the LOD mesh of a distant cell.
+ * @cell: Pointer to WorldLodCell to populate.
+ * @mx: Matrix X coordinate.
+ * @my: Matrix Y coordinate.
+ * @job: Loader job whose reads hold the cell's blobs, or NULL to look them up.
+ *
+ * Geometry and tilesets are only loaded for the duration of the build.
+ */
+static void world_load_lod_cell(WorldLodCell* cell, int mx, int my, WorldLoadJob* job)
+{
+    uint16_t header_id = world_matrix_get(&g_WorldMatrix, mx, my);
+    const WorldHeader* h = world_headers_get(&g_WorldHeaders, header_id);
+
+    cell->header_id = header_id;
+    cell->world_x = mx;
+    cell->world_y = my;
+    cell->vertical_offset = h ? h->vertical_offset : 0;
+    cell->loaded = true;
+
+    if (!h)
+        return;
+
+    Arena* scratch = arena_acquire();
+    GeometryMap* geometry = world_job_geometry(job, h->geometry_id, scratch, true);
+    Tileset* regional = world_job_tileset(job, TILESET_REGIONAL, h->regional_tileset_id);
+    Tileset* local = world_job_tileset(job, TILESET_LOCAL, h->local_tileset_id);
+    Tileset* interior = world_job_tileset(job, TILESET_INTERIOR, h->interior_tileset_id);
+
+    ChunkSource source = {
+        .geo             = geometry,
+        .regional        = regional,
+        .local           = local,
+        .interior        = interior,
+        .vertical_offset = cell->vertical_offset
+    };
+    lod_mesh_build(&cell->mesh, &source);
+
+    arena_release(scratch);
+    tileset_release(regional);
+    tileset_release(local);
+    tileset_release(interior);
+}
+
+static void world_unload_lod_cell(WorldLodCell* cell)
+{
+    lod_mesh_free(&cell->mesh);
+    cell->loaded = false;
+}
+
+/* Whether offset (dx, dy) lies within @radius cells of the center */
+static inline bool world_within(int dx, int dy, int radius)
+{
+    return abs(dx) <= radius && abs(dy) <= radius;
+}
+
+/* Whether grid offset (dx, dy) belongs to the LOD ring rather than the drawn full-detail cells */
+static bool world_in_lod_ring(const World* world, int dx, int dy)
+{
+    return !world_within(dx, dy, world->radii.render) && world_within(dx, dy, world->radii.lod);
+}
+
+/* Loader thread entry: list the blobs a job needs read from the pack */
+static void world_prepare_job(WorldLoadJob* job)
+{
+    uint16_t header_id = world_matrix_get(&g_WorldMatrix, job->world_x, job->world_y);
+    const WorldHeader* h = world_headers_get(&g_WorldHeaders, header_id);
+    if (!h)
+        return;
+
+    world_plan_read(job, ASSET_GEOMETRY, h->geometry_id);
+    if (job->kind == WORLD_LOAD_CELL)
+        world_plan_read(job, ASSET_COLLISION, h->collision_id);
+
+    // Cached tilesets need no read
+    const uint16_t tileset_ids[TILESET_KIND_COUNT] = {
+        [TILESET_REGIONAL] = h->regional_tileset_id,
+        [TILESET_LOCAL]    = h->local_tileset_id,
+        [TILESET_INTERIOR] = h->interior_tileset_id,
+    };
+    for (int kind = 0; kind < TILESET_KIND_COUNT; kind++)
+    {
+        if (!tileset_is_cached(kind, tileset_ids[kind]))
+            world_plan_read(job, world_tileset_asset(kind), tileset_ids[kind]);
+    }
+}
+
+/* Loader thread entry: parse the cell a job asks for once its reads are done */
+static void world_load_job(WorldLoadJob* job)
+{
+    if (job->kind == WORLD_LOAD_CELL)
+        world_load_cell(&job->cell, job->world_x, job->world_y, job);
+    else
+        world_load_lod_cell(&job->lod, job->world_x, job->world_y, job);
+
+    world_release_reads(job);
+}
+
+/* Unload the result of a job that is not needed any more */
+static void world_discard_job(WorldLoadJob* job)
+{
+    if (!job->loaded)
+    {
+        world_release_reads(job);
+        return;
+    }
+
+    if (job->kind == WORLD_LOAD_CELL)
+        world_unload_cell(&job->cell);
+    else
+        world_unload_lod_cell(&job->lod);
+}
+
+/* Whether the cell at (mx, my) belongs in the window around the current center */
+static bool world_wants(WorldLoadKind kind, int mx, int my, void* user)
+{
+    const World* world = user;
+    int dx = mx - world->cx;
+    int dy = my - world->cy;
+
+    if (kind == WORLD_LOAD_CELL)
+        return world_within(dx, dy, world->radii.load);
+
+    return world_in_lod_ring(world, dx, dy);
+}
+
+/**
+ * world_collect - Swap cells finished by the loader thread into their slots.
+ * @world: Pointer to World instance.
+ *
+ * A slot keeps its previous cell until the replacement arrives. Cells that
+ * left the window while they were loading are unloaded straight away.
+ */
+static void world_collect(World* world)
+{
+    WorldLoadJob* job;
+    while ((job = world_loader_collect()) != NULL)
+    {
+        if (!world_wants(job->kind, job->world_x, job->world_y, world))
+        {
+            world_discard_job(job);
+        }
+        else if (job->kind == WORLD_LOAD_CELL)
+        {
+            WorldCell* cell = world_cell_at(world, job->world_x - world->cx, job->world_y - world->cy);
+            if (cell->loaded)
+                world_unload_cell(cell);
+            *cell = job->cell;
+        }
+        else
+        {
+            WorldLodCell* cell = world_lod_at(world, job->world_x - world->cx, job->world_y - world->cy);
+            if (cell->loaded)
+                world_unload_lod_cell(cell);
+            *cell = job->lod;
+        }
+
+        world_loader_release(job);
+    }
+}
+
+/**
+ * world_stream - Load whatever the window around the center is missing.
+ * @world: Pointer to World instance.
+ * @async: Queue the missing cells on the loader thread instead of loading them here.
+ *
+ * Both grids are toroidal: a cell lives in the slot given by its matrix
+ * coordinates modulo the grid size, so after the center moves only slots
+ * still holding another cell (or nothing) are reloaded. Crossing one border
+ * loads a row of 2r+1 cells, a diagonal step 4r+1; the LOD ring works the
+ * same way.
+ */
+static void world_stream(World* world, bool async)
+{
+    if (!world->cells)
+        return;
+
+    // Cells queued for an earlier center may have left the window already
+    if (async)
+        world_loader_prune(world_wants, world);
+
+    int radius = world->radii.load;
+    for (int dy = -radius; dy <= radius; dy++)
+    {
+        for (int dx = -radius; dx <= radius; dx++)
+        {
+            WorldCell* cell = world_cell_at(world, dx, dy);
+            int mx = world->cx + dx;
+            int my = world->cy + dy;
+
+            if (cell->loaded && cell->world_x == mx && cell->world_y == my)
+                continue;
+
+            if (async)
+            {
+                world_loader_request(WORLD_LOAD_CELL, mx, my);
+                continue;
+            }
+
+            if (cell->loaded)
+                world_unload_cell(cell);
+            world_load_cell(cell, mx, my, NULL);
+        }
+    }
+
+    radius = world->radii.lod;
+    for (int dy = -radius; dy <= radius; dy++)
+    {
+        for (int dx = -radius; dx <= radius; dx++)
+        {
+            if (!world_in_lod_ring(world, dx, dy))
+                continue;
+
+            WorldLodCell* cell = world_lod_at(world, dx, dy);
+            int mx = world->cx + dx;
+            int my = world->cy + dy;
+
+            if (cell->loaded && cell->world_x == mx && cell->world_y == my)
+                continue;
+
+            if (async)
+            {
+                world_loader_request(WORLD_LOAD_LOD, mx, my);
+                continue;
+            }
+
+            if (cell->loaded)
+                world_unload_lod_cell(cell);
+            world_load_lod_cell(cell, mx, my, NULL);
+        }
+    }
+}
+
+/**
+ * world_update - Update world center based on player position and stream in new cells.
  * @world: Pointer to World instance.
  * @px: Player X position.
  * @pz: Player Z position.
+ *
+ * Never waits for the loader: cells it finished since the last call are
+ * swapped in, and cells that entered the window are queued.
  */
 void world_update(World* world, float px, float pz)
 {
-    int new_cx = (int)floor(px / MAP_WIDTH);
-    int new_cy = (int)floor(pz / MAP_HEIGHT);
+    world_collect(world);
+
+    int new_cx = world_cell_coord(px, MAP_WIDTH);
+    int new_cy = world_cell_coord(pz, MAP_HEIGHT);
 
     if (new_cx == world->cx && new_cy == world->cy)
         return;
@@ -101,47 +554,186 @@ void world_update(World* world, float px, float pz)
     world->cx = new_cx;
     world->cy = new_cy; 
 
-    // Reload 3x3 grid
-    for (int dy = -1; dy <= 1; dy++)
+    world_stream(world, true);
+}
+
+static ChunkSource world_cell_source(const WorldCell* cell)
+{
+    return (ChunkSource){
+        .geo             = cell->geometry,
+        .regional        = cell->regional_tileset,
+        .local           = cell->local_tileset,
+        .interior        = cell->interior_tileset,
+        .vertical_offset = cell->vertical_offset
+    };
+}
+
+void world_set_draw_order(WorldDrawOrder order)
+{
+    draw_order = order;
+}
+
+/**
+ * world_cell_order - (dx, dy) offset of the @i-th cell in drawing order.
+ * @facing: Camera direction.
+ * @radius: Radius of the drawn square of cells.
+ * @i: Position in the order, 0 .. (2 * @radius + 1)^2 - 1.
+ * @offset: Receives the offset.
+ *
+ * Front to back means rows of cells by increasing distance along @facing, and
+ * within a row the centre column first, then outwards alternating sides.
+ * The fixed order is plain row-major.
+ */
+static void world_cell_order(CameraCardinal facing, int radius, int i, int offset[2])
+{
+    int diameter = 2 * radius + 1;
+
+    if (draw_order != WORLD_DRAW_FRONT_TO_BACK)
     {
-        for (int dx = -1; dx <= 1; dx++)
-        {
-            WorldCell* cell = &world->cells[dy+1][dx+1];
-            world_unload_cell(cell);
-            world_load_cell(cell, new_cx + dx, new_cy + dy);
-        }
+        offset[0] = i % diameter - radius;
+        offset[1] = i / diameter - radius;
+        return;
     }
+
+    Vec3 forward = camera_cardinal_forward(facing);
+    int fx = (int)forward.x;
+    int fy = (int)forward.z;
+
+    int depth = i / diameter - radius;
+    int side = i % diameter;
+    int lateral = side % 2 ? -(side + 1) / 2 : side / 2;
+
+    // Map (depth, lateral) back to grid offsets; lateral runs along the perpendicular axis
+    offset[0] = depth * fx + lateral * fy;
+    offset[1] = depth * fy + lateral * fx;
+}
+
+/**
+ * world_cell_visible - Whether the occupied part of a cell may be on screen.
+ * @cell: Cell to test.
+ * @dx, @dy: Offset of the cell from the centre cell.
+ * @frustum: World-space view frustum.
+ *
+ * The box comes from the occupancy masks: tile (x, layer, y) covers
+ * [x, x+1] x [layer, layer+1] x [y-1, y] before the cell's offsets.
+ */
+static bool world_cell_visible(const WorldCell* cell, int dx, int dy, const Frustum* frustum)
+{
+    int min[3], max[3];
+    if (!cell->geometry || !geometry_bounds(cell->geometry, min, max))
+        return false;
+
+    float ox = (float)(dx * MAP_WIDTH);
+    float oy = (float)cell->vertical_offset;
+    float oz = (float)(dy * MAP_HEIGHT);
+
+    Vec3 lo = { ox + min[0], oy + min[1], oz + min[2] - 1 };
+    Vec3 hi = { ox + max[0], oy + max[1], oz + max[2] - 1 };
+
+    return frustum_intersects_aabb(frustum, lo, hi);
+}
+
+/* Draw the LOD mesh of the cell at offset (dx, dy), if it is loaded and on screen */
+static void world_render_lod_cell(World* world, int dx, int dy, const Frustum* frustum, Mat4 view, Mat4 projection)
+{
+    const WorldLodCell* cell = world_lod_ready(world, dx, dy);
+    if (!cell || cell->mesh.index_count == 0)
+        return;
+
+    const LodMesh* mesh = &cell->mesh;
+    Vec3 offset = { (float)(dx * MAP_WIDTH), (float)cell->vertical_offset, (float)(dy * MAP_HEIGHT) };
+    if (!frustum_intersects_aabb(frustum, vec3_add(mesh->min, offset), vec3_add(mesh->max, offset)))
+        return;
+
+    render_lod(mesh, mat4_translate(offset), view, projection);
 }
 
 /**
- * world_render - Render the currently loaded 3x3 world cells.
+ * world_render - Render the loaded cells within the render radius, then the LOD ring.
  * @world: Pointer to World instance.
  * @view: View matrix.
  * @projection: Projection matrix.
  */
 void world_render(World* world, Mat4 view, Mat4 projection)
 {
-    for (int dy = -1; dy <= 1; dy++)
+    if (!world->cells)
+        return;
+
+    CameraCardinal facing = camera_cardinal(view);
+    Frustum frustum = frustum_from_matrix(mat4_multiply(projection, view));
+    int radius = world->radii.render;
+    int drawn = (2 * radius + 1) * (2 * radius + 1);
+
+    for (int i = 0; i < drawn; i++)
     {
-        for (int dx = -1; dx <= 1; dx++)
+        int offset[2];
+        world_cell_order(facing, radius, i, offset);
+
+        int dx = offset[0];
+        int dy = offset[1];
+        WorldCell* cell = world_cell_ready(world, dx, dy);
+
+        // Until the loader delivers the cell, the LOD mesh it had while it
+        // was further away (if any) stands in for it
+        if (!cell)
         {
-            WorldCell* cell = &world->cells[dy+1][dx+1]; 
-
-            Mat4 model = mat4_translate((Vec3){
-                dx * MAP_WIDTH,
-                cell->vertical_offset,
-                dy * MAP_HEIGHT
-            });
-
-            render_map(
-                cell->geometry,
-                cell->regional_tileset,
-                cell->local_tileset,
-                cell->interior_tileset,
-                model,
-                view,
-                projection
-            );
+            world_render_lod_cell(world, dx, dy, &frustum, view, projection);
+            continue;
+        }
+
+        // Cells that are empty or off screen are neither baked nor drawn
+        if (!world_cell_visible(cell, dx, dy, &frustum))
+            continue;
+
+        ChunkSource source = world_cell_source(cell);
+        ChunkSource around[CHUNK_SIDE_COUNT];
+        const ChunkSource* neighbours[CHUNK_SIDE_COUNT] = { NULL };
+
+        // Neighbours outside the loaded grid count as air; loaded but undrawn ones still hide faces
+        const int sides[CHUNK_SIDE_COUNT][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+        for (int side = 0; side < CHUNK_SIDE_COUNT; side++)
+        {
+            int nx = dx + sides[side][0];
+            int ny = dy + sides[side][1];
+            if (!world_within(nx, ny, world->radii.load))
+                continue;
+
+            const WorldCell* neighbour = world_cell_ready(world, nx, ny);
+            if (!neighbour)
+                continue;
+
+            around[side] = world_cell_source(neighbour);
+            neighbours[side] = &around[side];
+        }
+
+        if (chunk_mesh_is_stale(&cell->mesh, &source, neighbours))
+            chunk_mesh_build(&cell->mesh, &source, neighbours);
+
+        // The mesh is static, so its faces only need relighting when the sun moves
+        chunk_mesh_update_lighting(&cell->mesh, &sun);
+
+        Mat4 model = mat4_translate((Vec3){
+            dx * MAP_WIDTH,
+            cell->vertical_offset,
+            dy * MAP_HEIGHT
+        });
+
+        render_map(&cell->mesh, model, view, projection, facing, draw_order == WORLD_DRAW_FRONT_TO_BACK);
+    }
+
+    // The LOD ring lies behind the full-detail cells, so drawing it last keeps
+    // the front-to-back order; rings further out go later still
+    for (int ring = radius + 1; ring <= world->radii.lod; ring++)
+    {
+        for (int dy = -ring; dy <= ring; dy++)
+        {
+            for (int dx = -ring; dx <= ring; dx++)
+            {
+                if (abs(dx) != ring && abs(dy) != ring)
+                    continue;
+
+                world_render_lod_cell(world, dx, dy, &frustum, view, projection);
+            }
         }
     }
 }
@@ -152,14 +744,29 @@ void world_render(World* world, Mat4 view, Mat4 projection)
  */
 void world_free(World* world)
 {
-    for (int y = 0; y < 3; y++)
+    world_loader_shutdown(world_discard_job);
+
+    for (int i = 0; i < world->diameter * world->diameter; i++)
     { 
-        for (int x = 0; x < 3; x++)
-        { 
-            world_unload_cell(&world->cells[y][x]);
-        }
+        if (world->cells[i].loaded)
+            world_unload_cell(&world->cells[i]);
     }
 
+    for (int i = 0; i < world->lod_diameter * world->lod_diameter; i++)
+    {
+        if (world->lod[i].loaded)
+            world_unload_lod_cell(&world->lod[i]);
+    }
+
+    free(world->cells);
+    free(world->lod);
+    world->cells = NULL;
+    world->lod = NULL;
+    world->diameter = 0;
+    world->lod_diameter = 0;
+
     world_matrix_free(&g_WorldMatrix);
     world_headers_free(&g_WorldHeaders);
+    tileset_cache_free();
+    arena_pool_free();
 }
\ No newline at end of file
@@ -2,56 +2,104 @@
 #include <stdlib.h>
 #include <string.h>
 
-CollisionMap* collision_load(uint16_t collision_id)
+/* Version 1: 6-byte header (magic, version), then the flags.
+ * Version 2: header padded to COLLISION_HEADER_V2 bytes, like geometry.
+ */
+#define COLLISION_HEADER_V1 6
+#define COLLISION_HEADER_V2 16
+#define COLLISION_TILE_COUNT (MAP_LAYERS * MAP_HEIGHT * MAP_WIDTH)
+
+CollisionMap* collision_load(uint16_t collision_id, Arena* arena)
+{
+    return collision_parse(asset_get(ASSET_COLLISION, collision_id), arena, true);
+}
+
+/* Pack the byte flags layer by layer */
+static bool collision_pack(CollisionMap* map, const uint8_t* payload)
 {
-    if (collision_id >= g_Collision_Count)
+    for (int layer = 0; layer < MAP_LAYERS; layer++)
     {
-        return NULL;
-    }
+        const uint8_t* flags = payload + (size_t)layer * PACKED_LAYER_SIZE;
+        uint16_t values[PACKED_LAYER_SIZE];
+        for (int i = 0; i < PACKED_LAYER_SIZE; i++)
+            values[i] = flags[i];
 
-    const Blob* blob = &g_Collision[collision_id];
-    const uint8_t* ptr = blob->data;
+        if (!packed_layer_build(&map->packed[layer], values, map->arena))
+            return false;
+    }
 
-    // Read magic
-    uint32_t magic = *(uint32_t*)ptr;
-    ptr += sizeof(uint32_t);
+    return true;
+}
 
-    if (magic != COLLISION_MAGIC)
+CollisionMap* collision_parse(const Blob* blob, Arena* arena, bool borrow)
+{
+    if (!blob || blob->size < COLLISION_HEADER_V1)
     {
         return NULL;
     }
 
-    // Read version
-    uint16_t version = *(uint16_t*)ptr;
-    ptr += sizeof(uint16_t);
+    // Read magic and version
+    uint32_t magic;
+    uint16_t version;
+    memcpy(&magic, blob->data, sizeof(magic));
+    memcpy(&version, blob->data + sizeof(magic), sizeof(version));
+
+    if (magic != COLLISION_MAGIC || (version != 1 && version != 2))
+    {
+        return NULL;
+    }
 
-    if (version != 1)
+    size_t header = version == 1 ? COLLISION_HEADER_V1 : COLLISION_HEADER_V2;
+    if (blob->size < header + COLLISION_TILE_COUNT)
     {
         return NULL;
     }
 
     // Allocate map
-    CollisionMap* map = malloc(sizeof(CollisionMap));
+    CollisionMap* map = arena_calloc(arena, 1, sizeof(CollisionMap));
+    if (!map)
+    {
+        return NULL;
+    }
 
-    // Read all tiles
-    for (int layer = 0; layer < MAP_LAYERS; layer++)
+    map->arena = arena;
+
+    if (borrow)
+    {
+        map->storage = MAP_STORAGE_VIEW;
+        map->tiles = blob->data + header;
+    }
+    else
     {
-        for (int y = 0; y < MAP_HEIGHT; y++)
+        map->storage = MAP_STORAGE_PACKED;
+        if (!collision_pack(map, blob->data + header))
         {
-            for (int x = 0; x < MAP_WIDTH; x++)
-            {
-                map->tiles[layer][y][x] = *(char*)ptr;
-                ptr += sizeof(char);
-            }
+            collision_free(map);
+            return NULL;
         }
     }
-    
+
     return map;
 }
 
 void collision_free(CollisionMap* map)
 {
-    if (map) {
-        free(map);
-    }
+    if (!map) return;
+
+    // Arena maps go away with their arena
+    if (map->arena) return;
+
+    for (int layer = 0; layer < MAP_LAYERS; layer++)
+        packed_layer_free(&map->packed[layer], NULL);
+
+    free(map);
+}
+
+size_t collision_bytes(const CollisionMap* map)
+{
+    size_t bytes = sizeof(CollisionMap);
+    for (int layer = 0; layer < MAP_LAYERS; layer++)
+        bytes += packed_layer_bytes(&map->packed[layer]);
+
+    return bytes;
 }
\ No newline at end of file
@@ -1,59 +1,245 @@
 #include "world/world_geometry.h"
 #include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
 
-GeometryMap* geometry_load(uint16_t geometry_id)
+/* Revisions are handed out globally so that no two map states ever share one,
+ * even if a freed map's memory is reused by the next load. 0 means "no map".
+ */
+static atomic_uint geometry_revisions;
+
+static uint32_t geometry_next_revision(void)
+{
+    return atomic_fetch_add(&geometry_revisions, 1) + 1;
+}
+
+/* Version 1: 6-byte header (magic, version), then the tiles.
+ * Version 2: header padded to GEOMETRY_HEADER_V2 bytes so the tiles can be used in place.
+ */
+#define GEOMETRY_HEADER_V1 6
+#define GEOMETRY_HEADER_V2 16
+#define GEOMETRY_TILE_COUNT (MAP_LAYERS * PACKED_LAYER_SIZE)
+
+/* Set the occupancy masks from the tiles */
+static void geometry_build_masks(GeometryMap* map)
 {
-    if (geometry_id >= g_Geometry_Count)
+    map->layers = 0;
+
+    for (int layer = 0; layer < MAP_LAYERS; layer++)
     {
-        return NULL;
+        for (int y = 0; y < MAP_HEIGHT; y++)
+        {
+            TileRef refs[MAP_WIDTH];
+            geometry_decode_row(map, layer, y, refs);
+
+            uint32_t row = 0;
+            for (int x = 0; x < MAP_WIDTH; x++)
+                row |= (uint32_t)(refs[x].packed != TILE_AIR) << x;
+
+            map->occupancy[layer][y] = row;
+            if (row)
+                map->layers |= 1u << layer;
+        }
+    }
+}
+
+/* Pack unaligned little-endian tiles layer by layer */
+static bool geometry_pack(GeometryMap* map, const uint8_t* payload)
+{
+    for (int layer = 0; layer < MAP_LAYERS; layer++)
+    {
+        uint16_t values[PACKED_LAYER_SIZE];
+        memcpy(values, payload + (size_t)layer * sizeof(values), sizeof(values));
+
+        if (!packed_layer_build(&map->packed[layer], values, map->arena))
+            return false;
     }
 
-    const Blob* blob = &g_Geometry[geometry_id];
-    const uint8_t* ptr = blob->data;
+    return true;
+}
 
-    // Read magic
-    uint32_t magic = *(uint32_t*)ptr;
-    ptr += sizeof(uint32_t);
+GeometryMap* geometry_load(uint16_t geometry_id, Arena* arena)
+{
+    return geometry_parse(asset_get(ASSET_GEOMETRY, geometry_id), arena, true);
+}
 
-    if (magic != GEOMETRY_MAGIC)
+GeometryMap* geometry_parse(const Blob* blob, Arena* arena, bool borrow)
+{
+    if (!blob || blob->size < GEOMETRY_HEADER_V1)
     {
         return NULL;
     }
 
-    // Read version
-    uint16_t version = *(uint16_t*)ptr;
-    ptr += sizeof(uint16_t);
+    // Read magic and version
+    uint32_t magic;
+    uint16_t version;
+    memcpy(&magic, blob->data, sizeof(magic));
+    memcpy(&version, blob->data + sizeof(magic), sizeof(version));
+
+    if (magic != GEOMETRY_MAGIC || (version != 1 && version != 2))
+    {
+        return NULL;
+    }
 
-    if (version != 1)
+    size_t header = version == 1 ? GEOMETRY_HEADER_V1 : GEOMETRY_HEADER_V2;
+    if (blob->size < header + GEOMETRY_TILE_COUNT * sizeof(TileRef))
     {
         return NULL;
     }
 
+    const uint8_t* payload = blob->data + header;
+
     // Allocate map
-    GeometryMap* map = malloc(sizeof(GeometryMap));
+    GeometryMap* map = arena_calloc(arena, 1, sizeof(GeometryMap));
+    if (!map)
+    {
+        return NULL;
+    }
 
-    // Read all tiles
-    for (int layer = 0; layer < MAP_LAYERS; layer++)
+    map->arena = arena;
+
+    if (borrow && (uintptr_t)payload % _Alignof(TileRef) == 0)
     {
-        for (int y = 0; y < MAP_HEIGHT; y++)
+        map->storage = MAP_STORAGE_VIEW;
+        map->tiles = (const TileRef*)payload;
+    }
+    else
+    {
+        map->storage = MAP_STORAGE_PACKED;
+        if (!geometry_pack(map, payload))
         {
-            for (int x = 0; x < MAP_WIDTH; x++)
-            {
-                map->tiles[layer][y][x].packed = *(uint16_t*)ptr;
-                ptr += sizeof(uint16_t);
-            }
+            geometry_free(map);
+            return NULL;
         }
     }
-    
+
+    map->revision = geometry_next_revision();
+    geometry_build_masks(map);
+
     return map;
 }
 
 void geometry_free(GeometryMap* map)
 {
-    if (map) {
-        free(map);
+    if (!map) return;
+
+    // Arena maps go away with their arena
+    if (map->arena) return;
+
+    if (map->storage == MAP_STORAGE_DENSE)
+        free((void*)map->tiles);
+
+    for (int layer = 0; layer < MAP_LAYERS; layer++)
+        packed_layer_free(&map->packed[layer], NULL);
+
+    free(map);
+}
+
+void geometry_decode_row(const GeometryMap* map, int layer, int y, TileRef out[MAP_WIDTH])
+{
+    if (map->tiles)
+    {
+        memcpy(out, &map->tiles[(size_t)layer * PACKED_LAYER_SIZE + y * MAP_WIDTH], MAP_WIDTH * sizeof(TileRef));
+        return;
+    }
+
+    uint16_t values[MAP_WIDTH];
+    packed_layer_decode(&map->packed[layer], (uint32_t)(y * MAP_WIDTH), MAP_WIDTH, values);
+
+    for (int x = 0; x < MAP_WIDTH; x++)
+        out[x].packed = values[x];
+}
+
+/* Give @map a private dense copy of its tiles before the first edit */
+static bool geometry_make_dense(GeometryMap* map)
+{
+    if (map->storage == MAP_STORAGE_DENSE)
+        return true;
+
+    TileRef* dense = arena_alloc(map->arena, GEOMETRY_TILE_COUNT * sizeof(TileRef));
+    if (!dense)
+        return false;
+
+    for (int layer = 0; layer < MAP_LAYERS; layer++)
+    {
+        for (int y = 0; y < MAP_HEIGHT; y++)
+            geometry_decode_row(map, layer, y, &dense[layer * PACKED_LAYER_SIZE + y * MAP_WIDTH]);
+
+        packed_layer_free(&map->packed[layer], map->arena);
+    }
+
+    map->tiles = dense;
+    map->storage = MAP_STORAGE_DENSE;
+    return true;
+}
+
+void geometry_set_tile(GeometryMap* map, int layer, int y, int x, TileRef ref)
+{
+    if (!map) return;
+    if (layer < 0 || layer >= MAP_LAYERS || y < 0 || y >= MAP_HEIGHT || x < 0 || x >= MAP_WIDTH) return;
+
+    if (geometry_get_tile(map, layer, y, x).packed == ref.packed) return;
+    if (!geometry_make_dense(map)) return;
+
+    ((TileRef*)map->tiles)[layer * PACKED_LAYER_SIZE + y * MAP_WIDTH + x] = ref;
+    map->revision = geometry_next_revision();
+
+    if (ref.packed != TILE_AIR)
+    {
+        map->occupancy[layer][y] |= 1u << x;
+        map->layers |= 1u << layer;
+        return;
     }
+
+    map->occupancy[layer][y] &= ~(1u << x);
+
+    for (int row = 0; row < MAP_HEIGHT; row++)
+    {
+        if (map->occupancy[layer][row])
+            return;
+    }
+    map->layers &= ~(1u << layer);
+}
+
+size_t geometry_bytes(const GeometryMap* map)
+{
+    size_t bytes = sizeof(GeometryMap);
+
+    if (map->storage == MAP_STORAGE_DENSE)
+        bytes += GEOMETRY_TILE_COUNT * sizeof(TileRef);
+
+    for (int layer = 0; layer < MAP_LAYERS; layer++)
+        bytes += packed_layer_bytes(&map->packed[layer]);
+
+    return bytes;
+}
+
+bool geometry_bounds(const GeometryMap* map, int min[3], int max[3])
+{
+    if (!map->layers)
+        return false;
+
+    uint32_t columns = 0;
+    uint32_t rows = 0;
+
+    for (uint32_t layers = map->layers; layers; layers &= layers - 1)
+    {
+        int layer = __builtin_ctz(layers);
+
+        for (int y = 0; y < MAP_HEIGHT; y++)
+        {
+            columns |= map->occupancy[layer][y];
+            rows |= (uint32_t)(map->occupancy[layer][y] != 0) << y;
+        }
+    }
+
+    min[0] = __builtin_ctz(columns);
+    max[0] = 32 - __builtin_clz(columns);
+    min[1] = __builtin_ctz(map->layers);
+    max[1] = 32 - __builtin_clz(map->layers);
+    min[2] = __builtin_ctz(rows);
+    max[2] = 32 - __builtin_clz(rows);
+    return true;
 }
 
 uint8_t tile_get_tileset(TileRef ref)
@@ -1,16 +1,57 @@
 #include "world/world_headers.h"
+#include <stdbool.h>
 #include <stdlib.h>
+#include "assets.h"
 #include <string.h>
 
-extern const uint8_t _binary_data_world_headers_hdr_start[] __asm__("_binary_data_world_headers_hdr_start");
-extern const uint8_t _binary_data_world_headers_hdr_end[] __asm__("_binary_data_world_headers_hdr_end");
-
 #define HEADER_MAGIC 0x20484247
 #define VERSION 1
 
+/* Magic, version and count, then eight 16-bit fields per header */
+#define PREFIX_SIZE 8
+#define RECORD_SIZE 16
+
+/* Fill the dense ID -> position table; false if out of memory */
+static bool world_headers_index(WorldHeaders* headers)
+{
+    uint32_t max_id = 0;
+    for (int i = 0; i < headers->count; i++)
+    {
+        if (headers->headers[i].header_id > max_id)
+            max_id = headers->headers[i].header_id;
+    }
+
+    headers->index_count = headers->count ? max_id + 1 : 0;
+    headers->index = malloc(headers->index_count * sizeof(uint16_t));
+    if (headers->index_count && !headers->index)
+        return false;
+
+    // 0xFF bytes make every entry WORLD_HEADER_MISSING
+    memset(headers->index, 0xFF, headers->index_count * sizeof(uint16_t));
+
+    for (int i = 0; i < headers->count; i++)
+    {
+        uint16_t* slot = &headers->index[headers->headers[i].header_id];
+        if (*slot == WORLD_HEADER_MISSING)
+            *slot = (uint16_t)i;
+    }
+
+    return true;
+}
+
 void world_headers_load(WorldHeaders* headers)
 {
-    const uint8_t* ptr = _binary_data_world_headers_hdr_start;
+    const Blob* blob = asset_get(ASSET_WORLD_HEADERS, 0);
+
+    *headers = (WorldHeaders){ 0 };
+
+    if (!blob || blob->size < PREFIX_SIZE)
+    {
+        return;
+    }
+
+    const uint8_t* ptr = blob->data;
+    size_t size = blob->size;
 
     // Read magic
     uint32_t magic = *(uint32_t*)ptr;
@@ -31,11 +72,22 @@ void world_headers_load(WorldHeaders* headers)
     }
 
     // Read count
-    headers->count = *(uint16_t*)ptr;
+    uint16_t count = *(uint16_t*)ptr;
     ptr += sizeof(uint16_t);
 
+    // WORLD_HEADER_MISSING is reserved, so positions stay below it
+    if (count == WORLD_HEADER_MISSING || (size_t)count * RECORD_SIZE > size - PREFIX_SIZE)
+    {
+        return;
+    }
+
     // Allocate headers
-    headers->headers = malloc(headers->count * sizeof(WorldHeader));
+    headers->headers = malloc(count * sizeof(WorldHeader));
+    if (!headers->headers)
+    {
+        return;
+    }
+    headers->count = count;
 
     // Read all headers
     for (int i = 0; i < headers->count; i++)
@@ -65,20 +117,28 @@ void world_headers_load(WorldHeaders* headers)
 
         ptr += sizeof(uint16_t);    // Skip reserved
     }
+
+    if (!world_headers_index(headers))
+    {
+        world_headers_free(headers);
+    }
 }
 
 void world_headers_free(WorldHeaders* headers) {
-    if (headers->headers) {
-        free(headers->headers);
-        headers->headers = NULL;
-    }
+    free(headers->headers);
+    free(headers->index);
+    *headers = (WorldHeaders){ 0 };
 }
 
 const WorldHeader* world_headers_get(const WorldHeaders* headers, uint16_t header_id) {
-    for (int i = 0; i < headers->count; i++) {
-        if (headers->headers[i].header_id == header_id) {
-            return &headers->headers[i];
-        }
+    if (header_id >= headers->index_count) {
+        return NULL;
+    }
+
+    uint16_t position = headers->index[header_id];
+    if (position == WORLD_HEADER_MISSING) {
+        return NULL;
     }
-    return NULL;
+
+    return &headers->headers[position];
 }
\ No newline at end of file
@@ -0,0 +1,312 @@
+/*
+ * world_loader.c - Background cell loader
+ *
+ * One thread takes jobs from a FIFO queue, has the prepare callback list the
+ * blobs they need and hands those reads to the async I/O stage. When a job's
+ * batch completes (on an I/O thread) it moves to the ready queue; the loader
+ * parses ready jobs through the load callback and moves them to a done
+ * queue. The main thread polls the done queue and swaps results in itself,
+ * so nothing it reads is ever written by the loader.
+ */
+
+#include "world/world_loader.h"
+#include "thread.h"
+#include <stdlib.h>
+
+typedef struct WorldLoadQueue {
+    WorldLoadJob* head;
+    WorldLoadJob* tail;
+} WorldLoadQueue;
+
+static struct
+{
+    Thread* thread;
+    Mutex* mutex;
+    CondVar* wake;
+
+    WorldLoadFunc prepare;
+    WorldLoadFunc load;
+    WorldLoadQueue queued;
+    WorldLoadQueue reading;
+    WorldLoadQueue ready;
+    WorldLoadQueue done;
+    WorldLoadJob* current;
+    int reading_count;
+    bool quit;
+} loader;
+
+static void queue_push(WorldLoadQueue* queue, WorldLoadJob* job)
+{
+    job->next = NULL;
+
+    if (queue->tail)
+        queue->tail->next = job;
+    else
+        queue->head = job;
+
+    queue->tail = job;
+}
+
+static WorldLoadJob* queue_pop(WorldLoadQueue* queue)
+{
+    WorldLoadJob* job = queue->head;
+    if (!job) return NULL;
+
+    queue->head = job->next;
+    if (!queue->head)
+        queue->tail = NULL;
+
+    job->next = NULL;
+    return job;
+}
+
+static void queue_remove(WorldLoadQueue* queue, WorldLoadJob* job)
+{
+    WorldLoadJob* previous = NULL;
+
+    for (WorldLoadJob* it = queue->head; it; previous = it, it = it->next)
+    {
+        if (it != job)
+            continue;
+
+        if (previous)
+            previous->next = job->next;
+        else
+            queue->head = job->next;
+
+        if (queue->tail == job)
+            queue->tail = previous;
+
+        job->next = NULL;
+        return;
+    }
+}
+
+static bool queue_contains(const WorldLoadQueue* queue, WorldLoadKind kind, int world_x, int world_y)
+{
+    for (const WorldLoadJob* job = queue->head; job; job = job->next)
+    {
+        if (job->kind == kind && job->world_x == world_x && job->world_y == world_y)
+            return true;
+    }
+
+    return false;
+}
+
+/* Runs on an I/O thread once every read of a job has finished */
+static void loader_read_done(AsyncBatch* batch)
+{
+    WorldLoadJob* job = batch->user;
+
+    mutex_lock(loader.mutex);
+    queue_remove(&loader.reading, job);
+    loader.reading_count--;
+    queue_push(&loader.ready, job);
+    condvar_broadcast(loader.wake);
+    mutex_unlock(loader.mutex);
+}
+
+/* Fill in the reads of @job; called without the lock */
+static void loader_prepare(WorldLoadJob* job)
+{
+    job->batch = (AsyncBatch){ .reads = job->reads, .done = loader_read_done, .user = job };
+
+    if (loader.prepare)
+        loader.prepare(job);
+}
+
+static void loader_main(void* arg)
+{
+    (void)arg;
+
+    mutex_lock(loader.mutex);
+    for (;;)
+    {
+        while (!loader.quit && !loader.ready.head &&
+            !(loader.queued.head && loader.reading_count < WORLD_LOAD_MAX_READING))
+            condvar_wait(loader.wake, loader.mutex);
+
+        if (loader.quit)
+            break;
+
+        // Parse what has arrived first; start more reads while the disk works
+        WorldLoadJob* job = queue_pop(&loader.ready);
+        if (job)
+        {
+            loader.current = job;
+
+            mutex_unlock(loader.mutex);
+            loader.load(job);
+            job->loaded = true;
+            mutex_lock(loader.mutex);
+
+            loader.current = NULL;
+            queue_push(&loader.done, job);
+            continue;
+        }
+
+        job = queue_pop(&loader.queued);
+        loader.current = job;
+
+        mutex_unlock(loader.mutex);
+        loader_prepare(job);
+        mutex_lock(loader.mutex);
+
+        loader.current = NULL;
+
+        if (job->batch.count == 0)
+        {
+            queue_push(&loader.ready, job);
+            continue;
+        }
+
+        // Listed before submitting: the batch may complete before the submit returns
+        queue_push(&loader.reading, job);
+        loader.reading_count++;
+
+        mutex_unlock(loader.mutex);
+        async_io_submit(&job->batch);
+        mutex_lock(loader.mutex);
+    }
+    mutex_unlock(loader.mutex);
+}
+
+void world_loader_init(WorldLoadFunc prepare, WorldLoadFunc load)
+{
+    loader.prepare = prepare;
+    loader.load = load;
+    loader.queued = (WorldLoadQueue){ NULL, NULL };
+    loader.reading = (WorldLoadQueue){ NULL, NULL };
+    loader.ready = (WorldLoadQueue){ NULL, NULL };
+    loader.done = (WorldLoadQueue){ NULL, NULL };
+    loader.current = NULL;
+    loader.reading_count = 0;
+    loader.quit = false;
+
+    loader.mutex = mutex_create();
+    loader.wake = condvar_create();
+    loader.thread = thread_create(loader_main, NULL);
+
+    // Without a loader thread reads are done synchronously at collect time
+    if (loader.thread)
+        async_io_init(true);
+}
+
+bool world_loader_request(WorldLoadKind kind, int world_x, int world_y)
+{
+    if (!loader.mutex) return false;
+
+    mutex_lock(loader.mutex);
+
+    const WorldLoadJob* current = loader.current;
+    bool busy = (current && current->kind == kind && current->world_x == world_x && current->world_y == world_y) ||
+        queue_contains(&loader.queued, kind, world_x, world_y) ||
+        queue_contains(&loader.reading, kind, world_x, world_y) ||
+        queue_contains(&loader.ready, kind, world_x, world_y) ||
+        queue_contains(&loader.done, kind, world_x, world_y);
+
+    WorldLoadJob* job = busy ? NULL : calloc(1, sizeof(WorldLoadJob));
+    if (job)
+    {
+        job->kind = kind;
+        job->world_x = world_x;
+        job->world_y = world_y;
+
+        queue_push(&loader.queued, job);
+        condvar_signal(loader.wake);
+    }
+
+    mutex_unlock(loader.mutex);
+    return job != NULL;
+}
+
+void world_loader_prune(WorldLoadWanted wanted, void* user)
+{
+    if (!loader.mutex) return;
+
+    mutex_lock(loader.mutex);
+
+    WorldLoadQueue kept = { NULL, NULL };
+    WorldLoadJob* job;
+    while ((job = queue_pop(&loader.queued)) != NULL)
+    {
+        if (wanted(job->kind, job->world_x, job->world_y, user))
+            queue_push(&kept, job);
+        else
+            free(job);
+    }
+    loader.queued = kept;
+
+    mutex_unlock(loader.mutex);
+}
+
+WorldLoadJob* world_loader_collect(void)
+{
+    if (!loader.mutex) return NULL;
+
+    mutex_lock(loader.mutex);
+    WorldLoadJob* job = queue_pop(&loader.done);
+
+    // No loader thread: read and load synchronously, one job per call
+    if (!job && !loader.thread)
+    {
+        job = queue_pop(&loader.queued);
+        if (job)
+        {
+            loader_prepare(job);
+            async_io_run(&job->batch);
+            loader.load(job);
+            job->loaded = true;
+        }
+    }
+    mutex_unlock(loader.mutex);
+
+    return job;
+}
+
+void world_loader_release(WorldLoadJob* job)
+{
+    free(job);
+}
+
+void world_loader_shutdown(WorldLoadFunc discard)
+{
+    if (!loader.mutex) return;
+
+    mutex_lock(loader.mutex);
+    loader.quit = true;
+    condvar_signal(loader.wake);
+    mutex_unlock(loader.mutex);
+
+    thread_join(loader.thread);
+    loader.thread = NULL;
+
+    // Read buffers must not be freed under the I/O threads
+    mutex_lock(loader.mutex);
+    while (loader.reading_count > 0)
+        condvar_wait(loader.wake, loader.mutex);
+    mutex_unlock(loader.mutex);
+
+    async_io_shutdown();
+
+    WorldLoadJob* job;
+    while ((job = queue_pop(&loader.queued)) != NULL)
+        free(job);
+
+    while ((job = queue_pop(&loader.ready)) != NULL)
+    {
+        discard(job);
+        free(job);
+    }
+
+    while ((job = queue_pop(&loader.done)) != NULL)
+    {
+        discard(job);
+        free(job);
+    }
+
+    condvar_destroy(loader.wake);
+    mutex_destroy(loader.mutex);
+    loader.wake = NULL;
+    loader.mutex = NULL;
+}
@@ -0,0 +1,218 @@
+#include "world/world_lod.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Append the quad a-b-c-d (a cycle), wound so that it faces along @normal */
+static void lod_emit_quad(LodMesh* mesh, const Vec3 p[4], Vec3 normal)
+{
+    Vec3 e1 = vec3_sub(p[1], p[0]);
+    Vec3 e2 = vec3_sub(p[2], p[0]);
+    bool flip = vec3_dot(vec3_cross(e1, e2), normal) < 0.0f;
+
+    uint32_t base = mesh->vertex_count;
+    for (int k = 0; k < 4; k++)
+    {
+        // Tile column (x, y) spans x in [x, x+1] and z in [y-1, y]; see the texel mapping in shade_pixel
+        mesh->vertices[mesh->vertex_count++] = (RasterVertex){
+            .x = p[k].x,
+            .y = p[k].y,
+            .z = p[k].z,
+            .u = p[k].x / (float)(MAP_WIDTH - 1),
+            .v = (p[k].z + 1.0f) / (float)(MAP_HEIGHT - 1)
+        };
+    }
+
+    static const uint32_t order[2][6] = { { 0, 1, 2, 0, 2, 3 }, { 0, 2, 1, 0, 3, 2 } };
+    for (int k = 0; k < 6; k++)
+        mesh->indices[mesh->index_count++] = base + order[flip][k];
+}
+
+/* Height of the top of the highest tile in column (x, y), or -1 and no tile when empty */
+static int lod_column_top(const ChunkSource* cell, int y, int x, const TileMesh** top)
+{
+    uint32_t layers = cell->geo->layers;
+
+    while (layers)
+    {
+        int layer = 31 - __builtin_clz(layers);
+        layers &= ~(1u << layer);
+
+        const TileMesh* tile = chunk_source_tile(cell, layer, y, x);
+        if (tile)
+        {
+            *top = tile;
+            return layer + 1;
+        }
+    }
+
+    *top = NULL;
+    return -1;
+}
+
+static uint32_t lod_mix(const uint32_t sum[3], uint32_t count)
+{
+    return 0xFF000000u | (sum[0] / count) << 16 | (sum[1] / count) << 8 | (sum[2] / count);
+}
+
+bool lod_mesh_build(LodMesh* mesh, const ChunkSource* cell)
+{
+    lod_mesh_free(mesh);
+
+    if (!cell->geo)
+        return false;
+
+    // Block heights and column colours
+    int block_top[LOD_GRID_Z][LOD_GRID_X];
+    int blocks = 0;
+
+    for (int bz = 0; bz < LOD_GRID_Z; bz++)
+    {
+        for (int bx = 0; bx < LOD_GRID_X; bx++)
+        {
+            uint32_t sum[3] = { 0, 0, 0 };
+            uint32_t count = 0;
+            int top = -1;
+
+            for (int y = bz * LOD_BLOCK; y < (bz + 1) * LOD_BLOCK; y++)
+            {
+                for (int x = bx * LOD_BLOCK; x < (bx + 1) * LOD_BLOCK; x++)
+                {
+                    const TileMesh* tile;
+                    int height = lod_column_top(cell, y, x, &tile);
+                    uint32_t color = tile ? tile->average_color : 0;
+
+                    mesh->colors[y][x] = color;
+                    if (height > top)
+                        top = height;
+
+                    if (color)
+                    {
+                        sum[0] += (color >> 16) & 0xFF;
+                        sum[1] += (color >> 8) & 0xFF;
+                        sum[2] += color & 0xFF;
+                        count++;
+                    }
+                }
+            }
+
+            // Columns without a colour of their own borrow the block's
+            uint32_t fill = count ? lod_mix(sum, count) : 0xFF000000u;
+            for (int y = bz * LOD_BLOCK; y < (bz + 1) * LOD_BLOCK; y++)
+                for (int x = bx * LOD_BLOCK; x < (bx + 1) * LOD_BLOCK; x++)
+                    if (!mesh->colors[y][x])
+                        mesh->colors[y][x] = fill;
+
+            block_top[bz][bx] = top;
+            if (top >= 0)
+                blocks++;
+        }
+    }
+
+    // Corner heights: mean of the non-empty blocks around each grid point
+    float corner[LOD_GRID_Z + 1][LOD_GRID_X + 1];
+
+    for (int gz = 0; gz <= LOD_GRID_Z; gz++)
+    {
+        for (int gx = 0; gx <= LOD_GRID_X; gx++)
+        {
+            int sum = 0, count = 0;
+
+            for (int bz = gz - 1; bz <= gz; bz++)
+            {
+                for (int bx = gx - 1; bx <= gx; bx++)
+                {
+                    if (bz < 0 || bz >= LOD_GRID_Z || bx < 0 || bx >= LOD_GRID_X || block_top[bz][bx] < 0)
+                        continue;
+
+                    sum += block_top[bz][bx];
+                    count++;
+                }
+            }
+
+            corner[gz][gx] = count ? (float)sum / (float)count : 0.0f;
+        }
+    }
+
+    // Every block gives one quad, plus a skirt quad for each of its (at most two) border edges
+    _Static_assert(LOD_GRID_X >= 2 && LOD_GRID_Z >= 2, "blocks touch at most two cell borders");
+    uint32_t quads = (uint32_t)blocks * 3;
+    mesh->arena = arena_acquire();
+    mesh->vertices = arena_alloc(mesh->arena, quads * 4 * sizeof(RasterVertex));
+    mesh->indices = arena_alloc(mesh->arena, quads * 6 * sizeof(uint32_t));
+    if (!mesh->arena || (quads > 0 && (!mesh->vertices || !mesh->indices)))
+    {
+        lod_mesh_free(mesh);
+        return false;
+    }
+
+    for (int bz = 0; bz < LOD_GRID_Z; bz++)
+    {
+        for (int bx = 0; bx < LOD_GRID_X; bx++)
+        {
+            if (block_top[bz][bx] < 0)
+                continue;
+
+            float x0 = (float)(bx * LOD_BLOCK), x1 = x0 + LOD_BLOCK;
+            float z0 = (float)(bz * LOD_BLOCK) - 1.0f, z1 = z0 + LOD_BLOCK;
+
+            Vec3 p[4] = {
+                { x0, corner[bz][bx],         z0 },
+                { x1, corner[bz][bx + 1],     z0 },
+                { x1, corner[bz + 1][bx + 1], z1 },
+                { x0, corner[bz + 1][bx],     z1 },
+            };
+            lod_emit_quad(mesh, p, (Vec3){ 0.0f, 1.0f, 0.0f });
+
+            // Skirts hang from the edges on the cell border down to the cell floor
+            const struct { bool on_border; int a, b; Vec3 normal; } edges[4] = {
+                { bz == 0,              0, 1, {  0.0f, 0.0f, -1.0f } },
+                { bx == LOD_GRID_X - 1, 1, 2, {  1.0f, 0.0f,  0.0f } },
+                { bz == LOD_GRID_Z - 1, 2, 3, {  0.0f, 0.0f,  1.0f } },
+                { bx == 0,              3, 0, { -1.0f, 0.0f,  0.0f } },
+            };
+
+            for (int e = 0; e < 4; e++)
+            {
+                if (!edges[e].on_border)
+                    continue;
+
+                Vec3 a = p[edges[e].a];
+                Vec3 b = p[edges[e].b];
+                Vec3 skirt[4] = { a, b, { b.x, 0.0f, b.z }, { a.x, 0.0f, a.z } };
+                lod_emit_quad(mesh, skirt, edges[e].normal);
+            }
+        }
+    }
+
+    for (uint32_t v = 0; v < mesh->vertex_count; v++)
+    {
+        const RasterVertex* rv = &mesh->vertices[v];
+        Vec3 p = { rv->x, rv->y, rv->z };
+
+        if (v == 0)
+        {
+            mesh->min = p;
+            mesh->max = p;
+            continue;
+        }
+
+        mesh->min = (Vec3){ fminf(mesh->min.x, p.x), fminf(mesh->min.y, p.y), fminf(mesh->min.z, p.z) };
+        mesh->max = (Vec3){ fmaxf(mesh->max.x, p.x), fmaxf(mesh->max.y, p.y), fmaxf(mesh->max.z, p.z) };
+    }
+
+    return true;
+}
+
+void lod_mesh_free(LodMesh* mesh)
+{
+    arena_release(mesh->arena);
+
+    mesh->arena = NULL;
+    mesh->vertices = NULL;
+    mesh->vertex_count = 0;
+    mesh->indices = NULL;
+    mesh->index_count = 0;
+    mesh->min = (Vec3){ 0.0f, 0.0f, 0.0f };
+    mesh->max = (Vec3){ 0.0f, 0.0f, 0.0f };
+}
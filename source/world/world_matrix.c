@@ -1,17 +1,23 @@
 #include "world/world_matrix.h"
 #include <stdlib.h>
+#include "assets.h"
 #include <string.h>
 
-// Embedded binary
-extern const uint8_t _binary_data_world_matrix_mtx_start[] __asm__("_binary_data_world_matrix_mtx_start");
-extern const uint8_t _binary_data_world_matrix_mtx_end[] __asm__("_binary_data_world_matrix_mtx_end");
-
 #define MATRIX_MAGIC 0x4D574247     // "GBWM"
 #define VERSION 1
 
+/* Magic, version, width and height */
+#define PREFIX_SIZE 10
+
 void world_matrix_load(WorldMatrix* matrix)
 {
-    const uint8_t* ptr = _binary_data_world_matrix_mtx_start;
+    const Blob* blob = asset_get(ASSET_WORLD_MATRIX, 0);
+    if (!blob || blob->size < PREFIX_SIZE)
+    {
+        return;
+    }
+
+    const uint8_t* ptr = blob->data;
 
     // Read magic
     uint32_t magic = *(uint32_t*)ptr;
@@ -41,8 +47,21 @@ void world_matrix_load(WorldMatrix* matrix)
     ptr += sizeof(uint16_t);
 
     // Allocate and copy cells
-    size_t cell_count = matrix->width * matrix->height;
+    size_t cell_count = (size_t)matrix->width * matrix->height;
+    if (cell_count * sizeof(uint16_t) > blob->size - PREFIX_SIZE)
+    {
+        matrix->width = 0;
+        matrix->height = 0;
+        return;
+    }
+
     matrix->cells = malloc(cell_count * sizeof(uint16_t));
+    if (!matrix->cells)
+    {
+        matrix->width = 0;
+        matrix->height = 0;
+        return;
+    }
     memcpy(matrix->cells, ptr, cell_count * sizeof(uint16_t));
 }
 
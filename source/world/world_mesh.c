@@ -0,0 +1,936 @@
+#include "world/world_mesh.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static const TileMesh* chunk_tile(
+    TileRef ref,
+    const Tileset* regional,
+    const Tileset* local,
+    const Tileset* interior)
+{
+    const Tileset* tileset = NULL;
+
+    switch (tile_get_tileset(ref))
+    {
+        case 0: tileset = regional; break;
+        case 1: tileset = local; break;
+        case 2: tileset = interior; break;
+        default: return NULL;
+    }
+
+    uint16_t tile_id = tile_get_id(ref);
+    if (!tileset || tile_id >= tileset->tile_count)
+        return NULL;
+
+    const TileMesh* tile = &tileset->tiles[tile_id];
+    if (tile->vertex_count == 0 || tile->index_count < 3)
+        return NULL;
+    if (!tile->pixels || tile->texture_width == 0 || tile->texture_height == 0)
+        return NULL;
+
+    return tile;
+}
+
+const TileMesh* chunk_source_tile(const ChunkSource* source, int layer, int y, int x)
+{
+    if (!source->geo)
+        return NULL;
+    if (layer < 0 || layer >= MAP_LAYERS || y < 0 || y >= MAP_HEIGHT || x < 0 || x >= MAP_WIDTH)
+        return NULL;
+    if (!geometry_is_occupied(source->geo, layer, y, x))
+        return NULL;
+
+    return chunk_tile(geometry_get_tile(source->geo, layer, y, x), source->regional, source->local, source->interior);
+}
+
+/* Palette lookups: cells use a handful of distinct textures and normals, so a
+ * linear search that first tries the previous hit is all that is needed.
+ */
+static int chunk_texture_slot(ChunkMesh* mesh, const TileMesh* tile, bool wrap, uint16_t* last)
+{
+    if (*last < mesh->texture_count &&
+        mesh->textures[*last].pixels == tile->pixels &&
+        mesh->textures[*last].wrap == wrap)
+        return *last;
+
+    for (uint16_t i = 0; i < mesh->texture_count; i++)
+    {
+        if (mesh->textures[i].pixels == tile->pixels && mesh->textures[i].wrap == wrap)
+            return *last = i;
+    }
+
+    if (mesh->texture_count == UINT16_MAX)
+        return -1;
+
+    RasterTexture* textures = realloc(mesh->textures, (mesh->texture_count + 1) * sizeof(RasterTexture));
+    if (!textures)
+        return -1;
+
+    mesh->textures = textures;
+    mesh->textures[mesh->texture_count] = (RasterTexture){
+        .pixels = tile->pixels,
+        .width  = tile->texture_width,
+        .height = tile->texture_height,
+        .wrap   = wrap
+    };
+
+    return *last = mesh->texture_count++;
+}
+
+static inline bool vec3_equal(Vec3 a, Vec3 b)
+{
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+static int chunk_normal_slot(ChunkMesh* mesh, Vec3 normal, uint16_t* last)
+{
+    if (*last < mesh->normal_count && vec3_equal(mesh->normals[*last], normal))
+        return *last;
+
+    for (uint16_t i = 0; i < mesh->normal_count; i++)
+    {
+        if (vec3_equal(mesh->normals[i], normal))
+            return *last = i;
+    }
+
+    if (mesh->normal_count == UINT16_MAX)
+        return -1;
+
+    Vec3* normals = realloc(mesh->normals, (mesh->normal_count + 1) * sizeof(Vec3));
+    if (!normals)
+        return -1;
+    mesh->normals = normals;
+
+    float* light = realloc(mesh->normal_light, (mesh->normal_count + 1) * sizeof(float));
+    if (!light)
+        return -1;
+    mesh->normal_light = light;
+
+    mesh->normals[mesh->normal_count] = normal;
+    mesh->normal_light[mesh->normal_count] = 1.0f;
+
+    return *last = mesh->normal_count++;
+}
+
+/* Tile at (layer, y, x) of @cell, where x and y may step one tile into a
+ * neighbouring cell. Layers are matched up through the cells' vertical offsets.
+ */
+static const TileMesh* chunk_tile_at(
+    const ChunkSource* cell,
+    const ChunkSource* const neighbours[CHUNK_SIDE_COUNT],
+    int layer, int y, int x)
+{
+    const ChunkSource* source = cell;
+
+    if (x < 0)                { source = neighbours[CHUNK_SIDE_WEST];  x += MAP_WIDTH; }
+    else if (x >= MAP_WIDTH)  { source = neighbours[CHUNK_SIDE_EAST];  x -= MAP_WIDTH; }
+    else if (y < 0)           { source = neighbours[CHUNK_SIDE_NORTH]; y += MAP_HEIGHT; }
+    else if (y >= MAP_HEIGHT) { source = neighbours[CHUNK_SIDE_SOUTH]; y -= MAP_HEIGHT; }
+
+    if (!source)
+        return NULL;
+
+    if (source != cell)
+        layer += cell->vertical_offset - source->vertical_offset;
+
+    return chunk_source_tile(source, layer, y, x);
+}
+
+/* Whether the triangle of @tile at (layer, y, x) lying on @face is covered by the neighbour's full face */
+static bool chunk_face_hidden(
+    const ChunkSource* cell,
+    const ChunkSource* const neighbours[CHUNK_SIDE_COUNT],
+    int layer, int y, int x, TileFace face)
+{
+    static const int steps[TILE_FACE_COUNT][3] = {
+        { -1,  0,  0 }, { 1, 0, 0 },    // x
+        {  0, -1,  0 }, { 0, 1, 0 },    // layer
+        {  0,  0, -1 }, { 0, 0, 1 },    // map y
+    };
+
+    const TileMesh* neighbour = chunk_tile_at(
+        cell, neighbours,
+        layer + steps[face][1],
+        y + steps[face][2],
+        x + steps[face][0]);
+
+    return neighbour && (neighbour->full_faces & TILE_FACE_BIT(TILE_FACE_OPPOSITE(face)));
+}
+
+static inline uint32_t chunk_source_revision(const ChunkSource* source)
+{
+    return source && source->geo ? source->geo->revision : 0;
+}
+
+/* =================================
+ * Greedy meshing
+ *
+ * Tile triangles that form a full axis-aligned unit square (`TileQuad`) are
+ * not emitted right away but collected per plane. Squares sharing plane,
+ * texture, normal and texture mapping are then merged into maximal rectangles,
+ * each drawn as two triangles with a repeating texture. Squares that merge
+ * with nothing keep their original triangles.
+  ================================== */
+#define CHUNK_GRID 32
+
+typedef struct ChunkQuad {
+    const TileMesh* tile;
+    uint8_t quad;               // Index into tile->quads
+    uint8_t layer, y, x;        // Tile position in the cell
+
+    uint8_t axis;
+    int8_t normal_sign;
+    int8_t uv[2][3];
+    float plane;                // Plane position along axis, in cell space
+    uint16_t normal;            // Normal palette slot
+    uint8_t s, t;               // Position in the plane's tile grid
+} ChunkQuad;
+
+typedef struct ChunkBuilder {
+    ChunkMesh* mesh;
+    uint32_t* remap;            // Tile vertex -> mesh vertex for the tile being emitted
+    uint32_t vertex_base;       // First vertex of the brick being built
+    uint16_t last_texture;
+    uint16_t last_normal;
+
+    ChunkQuad* quads;           // Squares of the brick being built
+    uint32_t quad_count;
+    uint32_t quad_capacity;
+
+    int32_t grid[CHUNK_GRID][CHUNK_GRID];   // Merge scratch, indexed [t][s]; -1 when empty
+} ChunkBuilder;
+
+_Static_assert(MAP_WIDTH == CHUNK_GRID && MAP_HEIGHT == CHUNK_GRID && MAP_LAYERS == CHUNK_GRID,
+    "greedy meshing assumes a cubic cell");
+_Static_assert(CHUNK_GRID % CHUNK_BRICK_SIZE == 0, "bricks must tile the cell");
+
+/* Orders quads by merge key first, then row-major by grid position */
+static int chunk_quad_compare(const void* pa, const void* pb)
+{
+    const ChunkQuad* a = pa;
+    const ChunkQuad* b = pb;
+
+    if (a->axis != b->axis) return a->axis < b->axis ? -1 : 1;
+    if (a->plane != b->plane) return a->plane < b->plane ? -1 : 1;
+    if (a->normal_sign != b->normal_sign) return a->normal_sign < b->normal_sign ? -1 : 1;
+    if (a->tile->pixels != b->tile->pixels) return (uintptr_t)a->tile->pixels < (uintptr_t)b->tile->pixels ? -1 : 1;
+    if (a->normal != b->normal) return a->normal < b->normal ? -1 : 1;
+
+    int uv = memcmp(a->uv, b->uv, sizeof(a->uv));
+    if (uv != 0) return uv;
+
+    if (a->t != b->t) return a->t < b->t ? -1 : 1;
+    if (a->s != b->s) return a->s < b->s ? -1 : 1;
+    return 0;
+}
+
+static bool chunk_quad_same_key(const ChunkQuad* a, const ChunkQuad* b)
+{
+    return a->axis == b->axis &&
+           a->plane == b->plane &&
+           a->normal_sign == b->normal_sign &&
+           a->tile->pixels == b->tile->pixels &&
+           a->tile->texture_width == b->tile->texture_width &&
+           a->tile->texture_height == b->tile->texture_height &&
+           a->normal == b->normal &&
+           memcmp(a->uv, b->uv, sizeof(a->uv)) == 0;
+}
+
+static bool chunk_add_quad(ChunkBuilder* b, const TileMesh* tile, uint8_t quad, int layer, int y, int x, uint16_t normal)
+{
+    if (b->quad_count == b->quad_capacity)
+    {
+        uint32_t capacity = b->quad_capacity ? b->quad_capacity * 2 : 1024;
+        ChunkQuad* quads = realloc(b->quads, capacity * sizeof(ChunkQuad));
+        if (!quads) return false;
+
+        b->quads = quads;
+        b->quad_capacity = capacity;
+    }
+
+    const TileQuad* q = &tile->quads[quad];
+    int index[3] = { x, layer, y };     // Tile position along x, y, z
+
+    ChunkQuad* out = &b->quads[b->quad_count++];
+    out->tile = tile;
+    out->quad = quad;
+    out->layer = (uint8_t)layer;
+    out->y = (uint8_t)y;
+    out->x = (uint8_t)x;
+    out->axis = q->axis;
+    out->normal_sign = q->normal_sign;
+    memcpy(out->uv, q->uv, sizeof(out->uv));
+    out->plane = (float)index[q->axis] + tile_min_corner(q->axis) + q->offset;
+    out->normal = normal;
+    out->s = (uint8_t)index[tile_plane_s_axis(q->axis)];
+    out->t = (uint8_t)index[tile_plane_t_axis(q->axis)];
+
+    return true;
+}
+
+/* Append triangle @i of @tile at (layer, y, x); b->remap must have been reset for the tile */
+static void chunk_emit_triangle(ChunkBuilder* b, const TileMesh* tile, uint32_t i, int layer, int y, int x, uint16_t texture, uint16_t normal)
+{
+    ChunkMesh* mesh = b->mesh;
+    uint32_t face = mesh->index_count / 3;
+
+    for (int k = 0; k < 3; k++)
+    {
+        uint16_t index = tile->indices[i + k];
+
+        // First use of this vertex: emit it
+        if (b->remap[index] == UINT32_MAX)
+        {
+            const Vertex* src = &tile->vertices[index];
+
+            b->remap[index] = mesh->vertex_count;
+            mesh->vertices[mesh->vertex_count++] = (RasterVertex){
+                .x = src->x + (float)x,
+                .y = src->y + (float)layer,
+                .z = src->z + (float)y,
+                .u = src->u,
+                .v = src->v
+            };
+        }
+
+        mesh->indices[mesh->index_count++] = b->remap[index] - b->vertex_base;
+    }
+
+    mesh->face_textures[face] = texture;
+    mesh->face_normals[face] = normal;
+}
+
+/* Whether triangle @i of @tile only references vertices the tile has */
+static inline bool chunk_triangle_valid(const TileMesh* tile, uint32_t i)
+{
+    return tile->indices[i + 0] < tile->vertex_count &&
+           tile->indices[i + 1] < tile->vertex_count &&
+           tile->indices[i + 2] < tile->vertex_count;
+}
+
+/* Upper bound on the vertices the builder emits for one @tile. Its loose
+ * triangles share one remap, so they need at most vertex_count. Each quad is
+ * emitted either as a lone square, which resets the remap and re-emits the
+ * vertices of its own triangles, or as part of a rectangle of n >= 2 squares
+ * whose 2n + 3 or fewer fan vertices come to at most 4 per square.
+ */
+static uint32_t chunk_tile_vertex_bound(const TileMesh* tile)
+{
+    uint32_t bound = tile->vertex_count;
+    if (!tile->face_quads || tile->quad_count == 0)
+        return bound;
+
+    uint32_t triangles[TILE_QUADS_MAX] = { 0 };
+    for (uint32_t i = 0; i + 2 < tile->index_count; i += 3)
+    {
+        uint8_t quad = tile->face_quads[i / 3];
+        if (quad < tile->quad_count)
+            triangles[quad]++;
+    }
+
+    for (uint8_t quad = 0; quad < tile->quad_count; quad++)
+    {
+        uint32_t lone = 3 * triangles[quad];
+        if (lone > tile->vertex_count)
+            lone = tile->vertex_count;
+
+        bound += lone > 4 ? lone : 4;
+    }
+
+    return bound;
+}
+
+static inline void chunk_reset_remap(ChunkBuilder* b, const TileMesh* tile)
+{
+    for (uint32_t v = 0; v < tile->vertex_count; v++)
+        b->remap[v] = UINT32_MAX;
+}
+
+/* Emit the rectangle of @w x @h grid squares starting at @q */
+static bool chunk_emit_rect(ChunkBuilder* b, const ChunkQuad* q, int w, int h)
+{
+    ChunkMesh* mesh = b->mesh;
+
+    // A lone square keeps its original triangles and clamped texture
+    if (w == 1 && h == 1)
+    {
+        const TileMesh* tile = q->tile;
+        int texture = chunk_texture_slot(mesh, tile, false, &b->last_texture);
+        if (texture < 0) return false;
+
+        chunk_reset_remap(b, tile);
+        for (uint32_t i = 0; i + 2 < tile->index_count; i += 3)
+        {
+            if (tile->face_quads[i / 3] == q->quad && chunk_triangle_valid(tile, i))
+                chunk_emit_triangle(b, tile, i, q->layer, q->y, q->x, (uint16_t)texture, q->normal);
+        }
+        return true;
+    }
+
+    int texture = chunk_texture_slot(mesh, q->tile, true, &b->last_texture);
+    if (texture < 0) return false;
+
+    int sa = tile_plane_s_axis(q->axis);
+    int ta = tile_plane_t_axis(q->axis);
+
+    // The rectangle is fanned around its centre through every grid point on its
+    // border, so edges shared with unmerged neighbours have no T-junctions
+    uint32_t centre = mesh->vertex_count - b->vertex_base;
+    uint32_t border = 2 * (uint32_t)(w + h);
+
+    for (uint32_t k = 0; k <= border; k++)
+    {
+        float s, t;
+        if (k == 0)                   { s = 0.5f * (float)w;     t = 0.5f * (float)h; }
+        else if (k <= (uint32_t)w)    { s = (float)(k - 1);      t = 0.0f; }
+        else if (k <= (uint32_t)(w + h))     { s = (float)w;     t = (float)(k - 1 - w); }
+        else if (k <= (uint32_t)(2 * w + h)) { s = (float)(2 * w + h - (k - 1)); t = (float)h; }
+        else                          { s = 0.0f;                t = (float)(border - (k - 1)); }
+
+        float pos[3];
+        pos[q->axis] = q->plane;
+        pos[sa] = (float)q->s + s + tile_min_corner(sa);
+        pos[ta] = (float)q->t + t + tile_min_corner(ta);
+
+        mesh->vertices[mesh->vertex_count++] = (RasterVertex){
+            .x = pos[0],
+            .y = pos[1],
+            .z = pos[2],
+            .u = q->uv[0][0] * s + q->uv[0][1] * t + q->uv[0][2],
+            .v = q->uv[1][0] * s + q->uv[1][1] * t + q->uv[1][2]
+        };
+    }
+
+    // The border runs towards +s first, so it turns counter-clockwise around
+    // the s x t direction; flip it when that is not the face's normal
+    int st_sign = (ta == (sa + 1) % 3) ? 1 : -1;
+    bool flip = st_sign != q->normal_sign;
+
+    for (uint32_t k = 0; k < border; k++)
+    {
+        uint32_t first = centre + 1 + k;
+        uint32_t second = centre + 1 + (k + 1) % border;
+        uint32_t face = mesh->index_count / 3;
+
+        mesh->indices[mesh->index_count++] = centre;
+        mesh->indices[mesh->index_count++] = flip ? second : first;
+        mesh->indices[mesh->index_count++] = flip ? first : second;
+        mesh->face_textures[face] = (uint16_t)texture;
+        mesh->face_normals[face] = q->normal;
+    }
+
+    return true;
+}
+
+/* Merge each run of equal-key quads (sorted row-major) into maximal rectangles.
+ * b->grid must be empty on entry and is left empty again.
+ */
+static bool chunk_merge_quads(ChunkBuilder* b)
+{
+    qsort(b->quads, b->quad_count, sizeof(ChunkQuad), chunk_quad_compare);
+
+    static const int32_t EMPTY = -1;
+    int32_t (*grid)[CHUNK_GRID] = b->grid;
+
+    uint32_t start = 0;
+    while (start < b->quad_count)
+    {
+        uint32_t end = start + 1;
+        while (end < b->quad_count && chunk_quad_same_key(&b->quads[start], &b->quads[end]))
+            end++;
+
+        // Every square of the run ends up in some rectangle, which empties the grid again
+        for (uint32_t i = start; i < end; i++)
+            grid[b->quads[i].t][b->quads[i].s] = (int32_t)i;
+
+        for (uint32_t i = start; i < end; i++)
+        {
+            const ChunkQuad* q = &b->quads[i];
+            int s0 = q->s, t0 = q->t;
+            if (grid[t0][s0] != (int32_t)i) continue;     // Already merged into an earlier rectangle
+
+            int w = 1;
+            while (s0 + w < CHUNK_GRID && grid[t0][s0 + w] != EMPTY)
+                w++;
+
+            int h = 1;
+            for (; t0 + h < CHUNK_GRID; h++)
+            {
+                bool full = true;
+                for (int s = s0; s < s0 + w && full; s++)
+                    full = grid[t0 + h][s] != EMPTY;
+                if (!full) break;
+            }
+
+            for (int t = t0; t < t0 + h; t++)
+                for (int s = s0; s < s0 + w; s++)
+                    grid[t][s] = EMPTY;
+
+            if (!chunk_emit_rect(b, q, w, h))
+                return false;
+        }
+
+        start = end;
+    }
+
+    return true;
+}
+
+/* =================================
+ * Per-direction face lists
+  ================================== */
+typedef struct ChunkFaceKey {
+    float key;
+    uint32_t face;
+} ChunkFaceKey;
+
+static int chunk_face_key_compare(const void* pa, const void* pb)
+{
+    const ChunkFaceKey* a = pa;
+    const ChunkFaceKey* b = pb;
+
+    if (a->key != b->key) return a->key < b->key ? -1 : 1;
+    return (a->face > b->face) - (a->face < b->face);
+}
+
+/* Append to @out the plane bounds of the @count triangles of @brick starting
+ * at list position @first, one per normal. @slot is scratch space sized for
+ * the mesh's normals and all UINT16_MAX, and is left that way. A triangle
+ * whose winding does not match its normal makes the list CHUNK_FACING_MIXED.
+ */
+static void chunk_build_facing(
+    const ChunkMesh* mesh,
+    ChunkBrick* brick,
+    CameraCardinal facing,
+    uint32_t first,
+    uint32_t count,
+    uint16_t* slot,
+    ChunkFaces* out)
+{
+    const RasterVertex* vertices = &mesh->vertices[brick->vertex_first];
+    ChunkFacing* planes = &out->facing[out->facing_count];
+    uint16_t plane_count = 0;
+    bool mixed = false;
+
+    for (uint32_t n = first; n < first + count && !mixed; n++)
+    {
+        uint16_t id = out->face_normals[n];
+        Vec3 normal = mesh->normals[id];
+        const uint32_t* tri = &out->indices[n * 3];
+
+        Vec3 p[3];
+        for (int k = 0; k < 3; k++)
+            p[k] = (Vec3){ vertices[tri[k]].x, vertices[tri[k]].y, vertices[tri[k]].z };
+
+        // Degenerate triangles never cover a pixel, whichever way they face
+        Vec3 winding = vec3_cross(vec3_sub(p[1], p[0]), vec3_sub(p[2], p[0]));
+        float length = vec3_length(winding);
+        if (length > 0.0f && vec3_dot(winding, normal) < CHUNK_FACING_AGREEMENT * length)
+        {
+            mixed = true;
+            break;
+        }
+
+        float height = fmaxf(vec3_dot(normal, p[0]), fmaxf(vec3_dot(normal, p[1]), vec3_dot(normal, p[2])));
+
+        if (slot[id] != UINT16_MAX)
+        {
+            ChunkFacing* plane = &planes[slot[id]];
+            plane->height = fmaxf(plane->height, height);
+        }
+        else if (plane_count < CHUNK_FACING_MIXED - 1)
+        {
+            slot[id] = plane_count;
+            planes[plane_count++] = (ChunkFacing){ height, id };
+        }
+        else
+        {
+            mixed = true;
+        }
+    }
+
+    for (uint16_t i = 0; i < plane_count; i++)
+        slot[planes[i].normal] = UINT16_MAX;
+
+    brick->facing_first[facing] = out->facing_count;
+    brick->facing_count[facing] = mixed ? CHUNK_FACING_MIXED : plane_count;
+    if (!mixed)
+        out->facing_count += plane_count;
+}
+
+/* Append to @out the triangles of @brick that can face a camera looking towards
+ * @facing, nearest-first along it, and their plane bounds. @keys, @hidden and
+ * @slot are scratch space sized for the brick's triangles and the mesh's normals.
+ */
+static void chunk_build_view(
+    const ChunkMesh* mesh,
+    ChunkBrick* brick,
+    CameraCardinal facing,
+    const bool* hidden,
+    ChunkFaceKey* keys,
+    uint16_t* slot,
+    ChunkFaces* out)
+{
+    Vec3 forward = camera_cardinal_forward(facing);
+    const RasterVertex* vertices = &mesh->vertices[brick->vertex_first];
+    uint32_t kept = 0;
+
+    for (uint32_t f = brick->face_first; f < brick->face_first + brick->face_count; f++)
+    {
+        if (hidden[mesh->face_normals[f]])
+            continue;
+
+        const uint32_t* tri = &mesh->indices[f * 3];
+        float key = 0.0f;
+
+        // Centroid distance along forward, times three: only the order matters
+        for (int k = 0; k < 3; k++)
+        {
+            const RasterVertex* v = &vertices[tri[k]];
+            key += v->x * forward.x + v->z * forward.z;
+        }
+
+        keys[kept++] = (ChunkFaceKey){ key, f };
+    }
+
+    qsort(keys, kept, sizeof(ChunkFaceKey), chunk_face_key_compare);
+
+    uint32_t first = out->index_count / 3;
+    brick->view_first[facing] = first;
+    brick->view_count[facing] = kept;
+
+    for (uint32_t n = 0; n < kept; n++)
+    {
+        uint32_t f = keys[n].face;
+
+        memcpy(&out->indices[(first + n) * 3], &mesh->indices[f * 3], 3 * sizeof(uint32_t));
+        out->face_textures[first + n] = mesh->face_textures[f];
+        out->face_normals[first + n] = mesh->face_normals[f];
+    }
+
+    out->index_count += kept * 3;
+
+    chunk_build_facing(mesh, brick, facing, first, kept, slot, out);
+}
+
+static bool chunk_build_views(ChunkMesh* mesh)
+{
+    uint32_t face_count = mesh->index_count / 3;
+    if (face_count == 0)
+        return true;
+
+    uint32_t max_brick_faces = 0;
+    for (int i = 0; i < CHUNK_BRICK_COUNT; i++)
+    {
+        if (mesh->bricks[i].face_count > max_brick_faces)
+            max_brick_faces = mesh->bricks[i].face_count;
+    }
+
+    ChunkFaceKey* keys = malloc(max_brick_faces * sizeof(ChunkFaceKey));
+    bool* hidden = malloc(mesh->normal_count * sizeof(bool));
+    uint16_t* slot = malloc(mesh->normal_count * sizeof(uint16_t));
+    float limit = sinf(CHUNK_VIEW_CONE_DEGREES * 3.14159265f / 180.0f);
+
+    bool ok = keys && hidden && slot;
+    if (slot)
+        memset(slot, 0xFF, mesh->normal_count * sizeof(uint16_t));
+
+    // A brick has at most one plane per triangle and per normal
+    uint32_t max_planes = mesh->normal_count * (uint32_t)CHUNK_BRICK_COUNT;
+    if (max_planes > face_count)
+        max_planes = face_count;
+
+    for (int facing = 0; ok && facing < CAMERA_CARDINAL_COUNT; facing++)
+    {
+        ChunkFaces* out = &mesh->views[facing];
+        Vec3 forward = camera_cardinal_forward((CameraCardinal)facing);
+
+        // Faces sharing a normal share the verdict, so decide once per palette entry
+        for (uint16_t n = 0; n < mesh->normal_count; n++)
+            hidden[n] = vec3_dot(mesh->normals[n], forward) >= limit;
+
+        // Sized for every face; the list only ever loses some
+        out->index_count = 0;
+        out->indices = arena_alloc(mesh->arena, face_count * 3 * sizeof(uint32_t));
+        out->face_textures = arena_alloc(mesh->arena, face_count * sizeof(uint16_t));
+        out->face_normals = arena_alloc(mesh->arena, face_count * sizeof(uint16_t));
+        out->facing_count = 0;
+        out->facing = arena_alloc(mesh->arena, max_planes * sizeof(ChunkFacing));
+        ok = out->indices && out->face_textures && out->face_normals && out->facing;
+
+        for (int i = 0; ok && i < CHUNK_BRICK_COUNT; i++)
+            chunk_build_view(mesh, &mesh->bricks[i], (CameraCardinal)facing, hidden, keys, slot, out);
+    }
+
+    free(keys);
+    free(hidden);
+    free(slot);
+    return ok;
+}
+
+/* Bounds of the vertices of @brick, or an empty box at the origin */
+static void chunk_brick_bounds(const ChunkMesh* mesh, ChunkBrick* brick)
+{
+    brick->min = (Vec3){ 0.0f, 0.0f, 0.0f };
+    brick->max = (Vec3){ 0.0f, 0.0f, 0.0f };
+
+    for (uint32_t v = 0; v < brick->vertex_count; v++)
+    {
+        const RasterVertex* rv = &mesh->vertices[brick->vertex_first + v];
+
+        if (v == 0 || rv->x < brick->min.x) brick->min.x = rv->x;
+        if (v == 0 || rv->y < brick->min.y) brick->min.y = rv->y;
+        if (v == 0 || rv->z < brick->min.z) brick->min.z = rv->z;
+        if (v == 0 || rv->x > brick->max.x) brick->max.x = rv->x;
+        if (v == 0 || rv->y > brick->max.y) brick->max.y = rv->y;
+        if (v == 0 || rv->z > brick->max.z) brick->max.z = rv->z;
+    }
+}
+
+/* Emit the visible triangles of the tile at (layer, y, x) and collect its unit squares */
+static bool chunk_build_tile(
+    ChunkBuilder* b,
+    const ChunkSource* cell,
+    const ChunkSource* const neighbours[CHUNK_SIDE_COUNT],
+    int layer, int y, int x)
+{
+    ChunkMesh* mesh = b->mesh;
+    const TileMesh* tile = chunk_tile(geometry_get_tile(cell->geo, layer, y, x), cell->regional, cell->local, cell->interior);
+    if (!tile)
+        return true;
+
+    int texture = -1;
+    uint32_t quads_seen = 0;
+
+    chunk_reset_remap(b, tile);
+
+    for (uint32_t i = 0; i + 2 < tile->index_count; i += 3)
+    {
+        uint32_t f = i / 3;
+
+        if (!chunk_triangle_valid(tile, i))
+            continue;
+
+        if (tile->face_planes && tile->face_planes[f] != TILE_FACE_NONE &&
+            chunk_face_hidden(cell, neighbours, layer, y, x, (TileFace)tile->face_planes[f]))
+            continue;
+
+        uint8_t quad = tile->face_quads ? tile->face_quads[f] : TILE_QUAD_NONE;
+        if (quad != TILE_QUAD_NONE && (quads_seen & (1u << quad)))
+            continue;
+
+        Vec3 normal = tile->normals ? tile->normals[f] : (Vec3){ 0.0f, 0.0f, 0.0f };
+        int slot = chunk_normal_slot(mesh, normal, &b->last_normal);
+        if (slot < 0)
+            return false;
+
+        if (quad != TILE_QUAD_NONE)
+        {
+            quads_seen |= 1u << quad;
+            if (!chunk_add_quad(b, tile, quad, layer, y, x, (uint16_t)slot))
+                return false;
+            continue;
+        }
+
+        if (texture < 0)
+            texture = chunk_texture_slot(mesh, tile, false, &b->last_texture);
+        if (texture < 0)
+            return false;
+
+        chunk_emit_triangle(b, tile, i, layer, y, x, (uint16_t)texture, (uint16_t)slot);
+    }
+
+    return true;
+}
+
+/* Emit every tile of the brick at brick coordinates (bx, by, bz), then merge its squares */
+static bool chunk_build_brick(
+    ChunkBuilder* b,
+    const ChunkSource* cell,
+    const ChunkSource* const neighbours[CHUNK_SIDE_COUNT],
+    int bx, int by, int bz)
+{
+    ChunkMesh* mesh = b->mesh;
+    const GeometryMap* geo = cell->geo;
+    ChunkBrick* brick = &mesh->bricks[CHUNK_BRICK_INDEX(bx, by, bz)];
+    const uint32_t brick_mask = (1u << CHUNK_BRICK_SIZE) - 1;
+
+    brick->vertex_first = mesh->vertex_count;
+    brick->face_first = mesh->index_count / 3;
+    b->vertex_base = mesh->vertex_count;
+    b->quad_count = 0;
+
+    uint32_t layers = (geo->layers >> (by * CHUNK_BRICK_SIZE)) & brick_mask;
+
+    for (; layers; layers &= layers - 1)
+    {
+        int layer = by * CHUNK_BRICK_SIZE + __builtin_ctz(layers);
+
+        for (int y = bz * CHUNK_BRICK_SIZE; y < (bz + 1) * CHUNK_BRICK_SIZE; y++)
+        {
+            uint32_t row = (geo->occupancy[layer][y] >> (bx * CHUNK_BRICK_SIZE)) & brick_mask;
+
+            for (; row; row &= row - 1)
+            {
+                int x = bx * CHUNK_BRICK_SIZE + __builtin_ctz(row);
+                if (!chunk_build_tile(b, cell, neighbours, layer, y, x))
+                    return false;
+            }
+        }
+    }
+
+    if (!chunk_merge_quads(b))
+        return false;
+
+    brick->vertex_count = mesh->vertex_count - brick->vertex_first;
+    brick->face_count = mesh->index_count / 3 - brick->face_first;
+    chunk_brick_bounds(mesh, brick);
+    return true;
+}
+
+bool chunk_mesh_build(
+    ChunkMesh* mesh,
+    const ChunkSource* cell,
+    const ChunkSource* const neighbours[CHUNK_SIDE_COUNT])
+{
+    chunk_mesh_free(mesh);
+
+    const GeometryMap* geo = cell->geo;
+    if (!geo)
+        return false;
+
+    // Pass 1: upper bounds for the arrays. Quads are emitted apart from the
+    // tile's other triangles, so they get their own vertex allowance; a merged
+    // rectangle of n >= 2 squares has at most two extra triangles, covered by
+    // reserving one per square
+    uint32_t vertex_count = 0;
+    uint32_t index_count = 0;
+    uint32_t max_tile_vertices = 0;
+
+    for (uint32_t layers = geo->layers; layers; layers &= layers - 1)
+    {
+        int layer = __builtin_ctz(layers);
+
+        for (int y = 0; y < MAP_HEIGHT; y++)
+        {
+            if (!geo->occupancy[layer][y])
+                continue;
+
+            TileRef refs[MAP_WIDTH];
+            geometry_decode_row(geo, layer, y, refs);
+
+            for (uint32_t row = geo->occupancy[layer][y]; row; row &= row - 1)
+            {
+                int x = __builtin_ctz(row);
+                const TileMesh* tile = chunk_tile(refs[x], cell->regional, cell->local, cell->interior);
+                if (!tile)
+                    continue;
+
+                vertex_count += chunk_tile_vertex_bound(tile);
+                index_count += tile->index_count - tile->index_count % 3 + tile->quad_count * 3;
+                if (tile->vertex_count > max_tile_vertices)
+                    max_tile_vertices = tile->vertex_count;
+            }
+        }
+    }
+
+    uint32_t face_count = index_count / 3;
+
+    mesh->arena = arena_acquire();
+    if (!mesh->arena)
+        return false;
+
+    ChunkBuilder* b = malloc(sizeof(ChunkBuilder));
+    if (!b)
+    {
+        chunk_mesh_free(mesh);
+        return false;
+    }
+
+    *b = (ChunkBuilder){ .mesh = mesh };
+    memset(b->grid, 0xFF, sizeof(b->grid));
+
+    mesh->vertices = arena_alloc(mesh->arena, vertex_count * sizeof(RasterVertex));
+    mesh->indices = arena_alloc(mesh->arena, index_count * sizeof(uint32_t));
+    mesh->face_textures = arena_alloc(mesh->arena, face_count * sizeof(uint16_t));
+    mesh->face_normals = arena_alloc(mesh->arena, face_count * sizeof(uint16_t));
+    b->remap = malloc(max_tile_vertices * sizeof(uint32_t));
+
+    bool ok = vertex_count == 0 ||
+        (mesh->vertices && mesh->indices && mesh->face_textures && mesh->face_normals && b->remap);
+
+    // Pass 2: brick by brick, copy the visible triangles of every tile,
+    // translated to its place in the cell, and merge its unit squares
+    for (int by = 0; ok && by < CHUNK_BRICKS_Y; by++)
+        for (int bz = 0; ok && bz < CHUNK_BRICKS_Z; bz++)
+            for (int bx = 0; ok && bx < CHUNK_BRICKS_X; bx++)
+                ok = chunk_build_brick(b, cell, neighbours, bx, by, bz);
+
+    // Pass 3: split into the per-direction face lists
+    if (ok)
+        ok = chunk_build_views(mesh);
+
+    free(b->remap);
+    free(b->quads);
+    free(b);
+
+    if (!ok)
+    {
+        chunk_mesh_free(mesh);
+        return false;
+    }
+
+    mesh->revision = geo->revision;
+    for (int side = 0; side < CHUNK_SIDE_COUNT; side++)
+        mesh->neighbour_revisions[side] = chunk_source_revision(neighbours[side]);
+
+    mesh->built = true;
+    return true;
+}
+
+bool chunk_mesh_is_stale(
+    const ChunkMesh* mesh,
+    const ChunkSource* cell,
+    const ChunkSource* const neighbours[CHUNK_SIDE_COUNT])
+{
+    if (!cell->geo) return false;
+    if (!mesh->built || mesh->revision != cell->geo->revision) return true;
+
+    for (int side = 0; side < CHUNK_SIDE_COUNT; side++)
+    {
+        if (mesh->neighbour_revisions[side] != chunk_source_revision(neighbours[side]))
+            return true;
+    }
+
+    return false;
+}
+
+void chunk_mesh_update_lighting(ChunkMesh* mesh, const DirectionalLight* light)
+{
+    if (mesh->lit &&
+        mesh->lit_by.dir.x == light->dir.x &&
+        mesh->lit_by.dir.y == light->dir.y &&
+        mesh->lit_by.dir.z == light->dir.z &&
+        mesh->lit_by.ambient == light->ambient &&
+        mesh->lit_by.intensity == light->intensity)
+        return;
+
+    for (uint16_t i = 0; i < mesh->normal_count; i++)
+        mesh->normal_light[i] = directional_light_factor(light, mesh->normals[i]);
+
+    mesh->lit_by = *light;
+    mesh->lit = true;
+}
+
+void chunk_mesh_free(ChunkMesh* mesh)
+{
+    // Vertices, indices and the view lists all go with the arena
+    arena_release(mesh->arena);
+
+    free(mesh->textures);
+    free(mesh->normals);
+    free(mesh->normal_light);
+
+    memset(mesh, 0, sizeof(*mesh));
+}
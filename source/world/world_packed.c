@@ -0,0 +1,111 @@
+#include "world/world_packed.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int compare_u16(const void* a, const void* b)
+{
+    return (int)*(const uint16_t*)a - (int)*(const uint16_t*)b;
+}
+
+/* Position of @value in the sorted @palette (it is always present) */
+static uint32_t palette_find(const uint16_t* palette, uint32_t count, uint16_t value)
+{
+    uint32_t lo = 0;
+    uint32_t hi = count;
+
+    while (hi - lo > 1)
+    {
+        uint32_t mid = (lo + hi) / 2;
+        if (palette[mid] <= value)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+bool packed_layer_build(PackedLayer* layer, const uint16_t values[PACKED_LAYER_SIZE], Arena* arena)
+{
+    *layer = (PackedLayer){ .fill = values[0] };
+
+    uint16_t sorted[PACKED_LAYER_SIZE];
+    memcpy(sorted, values, sizeof(sorted));
+    qsort(sorted, PACKED_LAYER_SIZE, sizeof(uint16_t), compare_u16);
+
+    uint32_t count = 1;
+    for (uint32_t i = 1; i < PACKED_LAYER_SIZE; i++)
+    {
+        if (sorted[i] != sorted[count - 1])
+            sorted[count++] = sorted[i];
+    }
+
+    if (count == 1)
+        return true;
+
+    uint8_t bits = count <= 2 ? 1 : count <= 4 ? 2 : count <= 16 ? 4 : count <= 256 ? 8 : 16;
+    size_t word_count = PACKED_LAYER_SIZE * bits / 32;
+    size_t palette_count = bits < 16 ? count : 0;
+
+    // Words first so they stay 4-byte aligned, palette right behind them
+    uint32_t* words = arena_calloc(arena, 1, word_count * sizeof(uint32_t) + palette_count * sizeof(uint16_t));
+    if (!words)
+        return false;
+
+    uint16_t* palette = palette_count ? (uint16_t*)(words + word_count) : NULL;
+    if (palette)
+        memcpy(palette, sorted, palette_count * sizeof(uint16_t));
+
+    for (uint32_t i = 0; i < PACKED_LAYER_SIZE; i++)
+    {
+        uint32_t index = palette ? palette_find(palette, count, values[i]) : values[i];
+        uint32_t bit = i * bits;
+        words[bit >> 5] |= index << (bit & 31);
+    }
+
+    layer->words = words;
+    layer->palette = palette;
+    layer->palette_count = (uint16_t)palette_count;
+    layer->bits = bits;
+    return true;
+}
+
+void packed_layer_free(PackedLayer* layer, Arena* arena)
+{
+    arena_free(arena, layer->words);
+    *layer = (PackedLayer){ 0 };
+}
+
+void packed_layer_decode(const PackedLayer* layer, uint32_t first, uint32_t count, uint16_t* out)
+{
+    if (layer->bits == 0)
+    {
+        for (uint32_t i = 0; i < count; i++)
+            out[i] = layer->fill;
+        return;
+    }
+
+    uint32_t mask = (1u << layer->bits) - 1;
+    uint32_t per_word = 32 / layer->bits;
+
+    for (uint32_t i = 0; i < count; )
+    {
+        uint32_t index = first + i;
+        uint32_t word = layer->words[index / per_word] >> (index % per_word * layer->bits);
+
+        // Unpack the rest of this word in one go
+        for (uint32_t k = index % per_word; k < per_word && i < count; k++, i++, word >>= layer->bits)
+        {
+            uint32_t value = word & mask;
+            out[i] = layer->bits == 16 ? (uint16_t)value : layer->palette[value];
+        }
+    }
+}
+
+size_t packed_layer_bytes(const PackedLayer* layer)
+{
+    if (layer->bits == 0)
+        return 0;
+
+    return PACKED_LAYER_SIZE * layer->bits / 8 + layer->palette_count * sizeof(uint16_t);
+}
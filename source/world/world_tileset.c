@@ -1,29 +1,564 @@
 #include "world/world_tileset.h"
-#include "generated/Tileset_Regional.h"
-#include "generated/Tileset_Local.h"
-#include "generated/Tileset_Interior.h"
+#include "thread.h"
+#include "assets.h"
 #include <stdlib.h>
 #include <string.h>
-#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
 
 #define TILESET_MAGIC 0x53544C47  // "GBTS"
 
-static FILE* debug_log = NULL;
+/* Version 1: vertices, indices, texture per tile.
+ * Version 2: adds one float3 normal per triangle right after the indices.
+ * Version 3: adds one u8 TileFace per triangle and a u8 full-face mask after the normals.
+ * Version 4: same data, laid out for use in place (see TilesetHeaderV4); nothing is copied.
+ */
+#define TILESET_VERSION_MIN 1
+#define TILESET_VERSION_MAX 4
+#define TILESET_VERSION_VIEW 4
 
-static Tileset* parse_tileset(const Blob* blob)
+/* Every array of a version 4 tileset starts at a multiple of this from the blob start */
+#define TILESET_VIEW_ALIGN 16
+
+/**
+ * TilesetHeaderV4 - Start of a version 4 tileset, followed by @tile_count
+ *                   `TilesetTileV4` records and then the bulk arrays
+ * @size: Total size of the tileset in bytes
+ */
+typedef struct TilesetHeaderV4 {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t tile_count;
+    uint32_t size;
+    uint32_t reserved;
+} TilesetHeaderV4;
+
+/**
+ * TilesetTileV4 - Where one tile's arrays live, as byte offsets from the blob start
+ *
+ * Air tiles have every count at 0. Otherwise vertices are `Vertex`, indices u16,
+ * normals float3 and face planes u8, one per triangle (index_count / 3), and
+ * pixels are RGBA32 texture_width * texture_height. Offsets of empty arrays are ignored.
+ */
+typedef struct TilesetTileV4 {
+    uint32_t vertex_offset;
+    uint32_t vertex_count;
+    uint32_t index_offset;
+    uint32_t index_count;
+    uint32_t normal_offset;
+    uint32_t face_plane_offset;
+    uint32_t pixel_offset;
+    uint16_t texture_width;
+    uint16_t texture_height;
+    uint8_t full_faces;
+    uint8_t reserved[3];
+} TilesetTileV4;
+
+_Static_assert(sizeof(TilesetHeaderV4) == 16, "tileset v4 header layout");
+_Static_assert(sizeof(TilesetTileV4) == 36, "tileset v4 tile record layout");
+_Static_assert(sizeof(Vertex) == 5 * sizeof(float), "tileset vertices are read in place");
+_Static_assert(sizeof(Vec3) == 3 * sizeof(float), "tileset normals are read in place");
+
+/* Tolerance for "lies on a tile boundary" and "covers the whole face" */
+#define TILE_FACE_EPSILON 1e-4f
+
+static inline float axis_of(const Vertex* v, int axis)
+{
+    return axis == 0 ? v->x : axis == 1 ? v->y : v->z;
+}
+
+static inline bool nearly(float a, float b)
+{
+    return fabsf(a - b) < TILE_FACE_EPSILON;
+}
+
+/* Round @value to -1, 0 or 1, or return false if it is none of them */
+static bool unit_coefficient(float value, int8_t* out)
+{
+    for (int c = -1; c <= 1; c++)
+    {
+        if (nearly(value, (float)c)) { *out = (int8_t)c; return true; }
+    }
+    return false;
+}
+
+/* Check that the triangles tagged with @quad form the whole unit square with an
+ * axis-aligned, non-stretched texture mapping, and fill in the mapping.
+ */
+static bool validate_quad(const TileMesh* tile, uint8_t quad, TileQuad* q)
+{
+    int sa = tile_plane_s_axis(q->axis);
+    int ta = tile_plane_t_axis(q->axis);
+
+    bool have[4] = { false };
+    float cu[4], cv[4];
+    float area = 0.0f;
+
+    for (uint32_t f = 0; f < tile->index_count / 3; f++)
+    {
+        if (tile->face_quads[f] != quad) continue;
+
+        const Vertex* p[3];
+        for (int k = 0; k < 3; k++)
+        {
+            const Vertex* v = p[k] = &tile->vertices[tile->indices[f * 3 + k]];
+
+            float s = axis_of(v, sa) - tile_min_corner(sa);
+            float t = axis_of(v, ta) - tile_min_corner(ta);
+
+            int cs = nearly(s, 0.0f) ? 0 : nearly(s, 1.0f) ? 1 : -1;
+            int ct = nearly(t, 0.0f) ? 0 : nearly(t, 1.0f) ? 1 : -1;
+            if (cs < 0 || ct < 0) return false;
+
+            int corner = ct * 2 + cs;
+            if (have[corner] && (!nearly(cu[corner], v->u) || !nearly(cv[corner], v->v)))
+                return false;
+
+            have[corner] = true;
+            cu[corner] = v->u;
+            cv[corner] = v->v;
+        }
+
+        Vec3 cross = vec3_cross(
+            (Vec3){ p[1]->x - p[0]->x, p[1]->y - p[0]->y, p[1]->z - p[0]->z },
+            (Vec3){ p[2]->x - p[0]->x, p[2]->y - p[0]->y, p[2]->z - p[0]->z });
+        area += 0.5f * vec3_length(cross);
+    }
+
+    if (!have[0] || !have[1] || !have[2] || !have[3] || !nearly(area, 1.0f))
+        return false;
+
+    const float* uv[2] = { cu, cv };
+    for (int c = 0; c < 2; c++)
+    {
+        const float* w = uv[c];
+        int8_t ds, dt, base;
+
+        if (!unit_coefficient(w[1] - w[0], &ds) ||
+            !unit_coefficient(w[2] - w[0], &dt) ||
+            !unit_coefficient(w[0], &base) ||
+            !nearly(w[3], w[0] + ds + dt))
+            return false;
+
+        // Exactly one in-plane axis per coordinate, covering [0, 1] once
+        int8_t slope = ds + dt;
+        if ((ds != 0) == (dt != 0) || base != (slope < 0 ? 1 : 0))
+            return false;
+
+        q->uv[c][0] = ds;
+        q->uv[c][1] = dt;
+        q->uv[c][2] = base;
+    }
+
+    // u and v must run along different axes
+    return (q->uv[0][0] != 0) != (q->uv[1][0] != 0);
+}
+
+/* Group the triangles of @tile into axis-aligned unit squares that greedy
+ * meshing can merge. Triangles that are not part of such a square keep
+ * TILE_QUAD_NONE and are always meshed as they are.
+ */
+static void derive_quads(TileMesh* tile, uint8_t* face_quads)
+{
+    uint32_t face_count = tile->index_count / 3;
+    tile->face_quads = face_quads;
+    tile->quad_count = 0;
+
+    for (uint32_t f = 0; f < face_count; f++)
+    {
+        face_quads[f] = TILE_QUAD_NONE;
+
+        const Vertex* a = &tile->vertices[tile->indices[f * 3 + 0]];
+        const Vertex* b = &tile->vertices[tile->indices[f * 3 + 1]];
+        const Vertex* c = &tile->vertices[tile->indices[f * 3 + 2]];
+        Vec3 n = tile->normals ? tile->normals[f] : (Vec3){ 0.0f, 0.0f, 0.0f };
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float na = axis == 0 ? n.x : axis == 1 ? n.y : n.z;
+            float pa = axis_of(a, axis);
+
+            if (fabsf(na) < 1.0f - TILE_FACE_EPSILON) continue;
+            if (!nearly(axis_of(b, axis), pa) || !nearly(axis_of(c, axis), pa)) break;
+
+            TileQuad key = {
+                .axis = (uint8_t)axis,
+                .normal_sign = na > 0.0f ? 1 : -1,
+                .offset = pa - tile_min_corner(axis),
+                .face = f
+            };
+
+            uint8_t q = 0;
+            while (q < tile->quad_count &&
+                   !(tile->quads[q].axis == key.axis &&
+                     tile->quads[q].normal_sign == key.normal_sign &&
+                     nearly(tile->quads[q].offset, key.offset)))
+                q++;
+
+            if (q == tile->quad_count)
+            {
+                if (q == TILE_QUADS_MAX) break;
+                tile->quads[tile->quad_count++] = key;
+            }
+
+            face_quads[f] = q;
+            break;
+        }
+    }
+
+    // Keep only the groups that really are unit squares; compact the rest away
+    uint8_t kept = 0;
+    for (uint8_t q = 0; q < tile->quad_count; q++)
+    {
+        TileQuad quad = tile->quads[q];
+        bool valid = validate_quad(tile, q, &quad);
+
+        for (uint32_t f = 0; f < face_count; f++)
+        {
+            if (face_quads[f] == q)
+                face_quads[f] = valid ? kept : TILE_QUAD_NONE;
+        }
+
+        if (valid)
+            tile->quads[kept++] = quad;
+    }
+    tile->quad_count = kept;
+}
+
+static TileFace classify_face(const Vertex* a, const Vertex* b, const Vertex* c, Vec3 n)
+{
+    const float bounds[TILE_FACE_COUNT] = { 0.0f, 1.0f, 0.0f, 1.0f, -1.0f, 0.0f };
+
+    for (int face = 0; face < TILE_FACE_COUNT; face++)
+    {
+        int axis = face / 2;
+        float bound = bounds[face];
+        float outward = (face & 1) ? 1.0f : -1.0f;
+
+        float pa = axis == 0 ? a->x : axis == 1 ? a->y : a->z;
+        float pb = axis == 0 ? b->x : axis == 1 ? b->y : b->z;
+        float pc = axis == 0 ? c->x : axis == 1 ? c->y : c->z;
+        float pn = axis == 0 ? n.x : axis == 1 ? n.y : n.z;
+
+        if (fabsf(pa - bound) < TILE_FACE_EPSILON &&
+            fabsf(pb - bound) < TILE_FACE_EPSILON &&
+            fabsf(pc - bound) < TILE_FACE_EPSILON &&
+            pn * outward > 0.5f)
+            return (TileFace)face;
+    }
+
+    return TILE_FACE_NONE;
+}
+
+/* Tag every triangle with the face it lies on, and mark a face full when the
+ * triangles on it add up to the whole unit square and the texture is opaque.
+ * Used for tilesets older than version 3.
+ */
+static void derive_faces(TileMesh* tile, uint8_t* face_planes)
+{
+    float covered[TILE_FACE_COUNT] = { 0 };
+    uint32_t face_count = tile->index_count / 3;
+
+    for (uint32_t f = 0; f < face_count; f++)
+    {
+        const Vertex* a = &tile->vertices[tile->indices[f * 3 + 0]];
+        const Vertex* b = &tile->vertices[tile->indices[f * 3 + 1]];
+        const Vertex* c = &tile->vertices[tile->indices[f * 3 + 2]];
+
+        Vec3 n = tile->normals ? tile->normals[f] : (Vec3){ 0.0f, 0.0f, 0.0f };
+        TileFace face = classify_face(a, b, c, n);
+        face_planes[f] = (uint8_t)face;
+
+        if (face == TILE_FACE_NONE) continue;
+
+        Vec3 cross = vec3_cross(
+            (Vec3){ b->x - a->x, b->y - a->y, b->z - a->z },
+            (Vec3){ c->x - a->x, c->y - a->y, c->z - a->z });
+        covered[face] += 0.5f * vec3_length(cross);
+    }
+
+    bool opaque = tile->pixels != NULL;
+    size_t pixel_count = (size_t)tile->texture_width * tile->texture_height;
+    for (size_t i = 0; opaque && i < pixel_count; i++)
+        opaque = (tile->pixels[i] >> 24) == 0xFF;
+
+    tile->full_faces = 0;
+    for (int face = 0; opaque && face < TILE_FACE_COUNT; face++)
+    {
+        if (covered[face] > 1.0f - TILE_FACE_EPSILON)
+            tile->full_faces |= TILE_FACE_BIT(face);
+    }
+}
+
+/* Mean RGB of the pixels that are not fully transparent, stored opaque */
+static void derive_average_color(TileMesh* tile)
+{
+    uint64_t sum[3] = { 0, 0, 0 };
+    uint64_t count = 0;
+    size_t pixel_count = (size_t)tile->texture_width * tile->texture_height;
+
+    for (size_t i = 0; tile->pixels && i < pixel_count; i++)
+    {
+        uint32_t p = tile->pixels[i];
+        if ((p >> 24) == 0) continue;
+
+        sum[0] += (p >> 16) & 0xFF;
+        sum[1] += (p >> 8) & 0xFF;
+        sum[2] += p & 0xFF;
+        count++;
+    }
+
+    if (count == 0)
+    {
+        tile->average_color = 0;
+        return;
+    }
+
+    tile->average_color = 0xFF000000u |
+        (uint32_t)(sum[0] / count) << 16 |
+        (uint32_t)(sum[1] / count) << 8 |
+        (uint32_t)(sum[2] / count);
+}
+
+/* Whether @count items of @size bytes at @offset fit in [@start, @end) on a TILESET_VIEW_ALIGN boundary */
+static bool view_range(uint32_t offset, uint64_t count, size_t size, size_t start, size_t end)
+{
+    if (count == 0) return true;
+    return offset % TILESET_VIEW_ALIGN == 0 && offset >= start && (uint64_t)offset + count * size <= end;
+}
+
+/* Build a version 4 tileset whose tiles point into @blob. Everything is validated
+ * up front, so a bad record rejects the whole tileset instead of a partial one.
+ */
+static Tileset* view_tileset(const Blob* blob)
+{
+    TilesetHeaderV4 header;
+    if (blob->size < sizeof(header) || (uintptr_t)blob->data % _Alignof(Vertex) != 0)
+        return NULL;
+
+    memcpy(&header, blob->data, sizeof(header));
+
+    size_t start = sizeof(header) + (size_t)header.tile_count * sizeof(TilesetTileV4);
+    size_t end = header.size;
+    if (end > blob->size || start > end)
+        return NULL;
+
+    const TilesetTileV4* records = (const TilesetTileV4*)(blob->data + sizeof(header));
+    size_t face_total = 0;
+
+    for (uint16_t i = 0; i < header.tile_count; i++)
+    {
+        const TilesetTileV4* r = &records[i];
+        if (r->vertex_count == 0) continue;
+
+        uint32_t face_count = r->index_count / 3;
+        size_t pixel_count = (size_t)r->texture_width * r->texture_height;
+
+        if (!view_range(r->vertex_offset, r->vertex_count, sizeof(Vertex), start, end) ||
+            !view_range(r->index_offset, r->index_count, sizeof(uint16_t), start, end) ||
+            !view_range(r->normal_offset, face_count, sizeof(Vec3), start, end) ||
+            !view_range(r->face_plane_offset, face_count, sizeof(uint8_t), start, end) ||
+            !view_range(r->pixel_offset, pixel_count, sizeof(uint32_t), start, end))
+            return NULL;
+
+        // Quad derivation follows the indices, so they must be in range too
+        const uint16_t* indices = (const uint16_t*)(blob->data + r->index_offset);
+        for (uint32_t k = 0; k < face_count * 3; k++)
+        {
+            if (indices[k] >= r->vertex_count)
+                return NULL;
+        }
+
+        face_total += face_count;
+    }
+
+    Tileset* tileset = malloc(sizeof(Tileset));
+    if (!tileset) return NULL;
+
+    tileset->tile_count = header.tile_count;
+    tileset->borrowed = true;
+    tileset->blob = NULL;
+    tileset->tiles = calloc(header.tile_count ? header.tile_count : 1, sizeof(TileMesh));
+    tileset->storage = malloc(face_total ? face_total : 1);
+
+    if (!tileset->tiles || !tileset->storage)
+    {
+        free(tileset->tiles);
+        free(tileset->storage);
+        free(tileset);
+        return NULL;
+    }
+
+    uint8_t* face_quads = tileset->storage;
+
+    for (uint16_t i = 0; i < header.tile_count; i++)
+    {
+        const TilesetTileV4* r = &records[i];
+        TileMesh* tile = &tileset->tiles[i];
+
+        // Air tile: leave it empty
+        if (r->vertex_count == 0) continue;
+
+        uint32_t face_count = r->index_count / 3;
+
+        tile->vertices = (const Vertex*)(blob->data + r->vertex_offset);
+        tile->vertex_count = r->vertex_count;
+        tile->indices = r->index_count ? (const uint16_t*)(blob->data + r->index_offset) : NULL;
+        tile->index_count = r->index_count;
+        tile->normals = face_count ? (const Vec3*)(blob->data + r->normal_offset) : NULL;
+        tile->face_planes = face_count ? blob->data + r->face_plane_offset : NULL;
+        tile->full_faces = r->full_faces & ((1u << TILE_FACE_COUNT) - 1);
+        tile->texture_width = r->texture_width;
+        tile->texture_height = r->texture_height;
+        tile->pixels = (size_t)r->texture_width * r->texture_height > 0
+            ? (const uint32_t*)(blob->data + r->pixel_offset) : NULL;
+
+        derive_quads(tile, face_quads);
+        face_quads += face_count;
+
+        derive_average_color(tile);
+    }
+
+    return tileset;
+}
+
+/* Parse one version 1-3 tile at *@cursor into owned copies. Fails on truncated
+ * data, out-of-range indices or a failed allocation; whatever was copied so far
+ * stays in @tile for tileset_free.
+ */
+static bool parse_tile(TileMesh* tile, uint16_t version, const uint8_t** cursor, const uint8_t* end)
 {
-    debug_log = fopen("parse_tileset_debug.txt", "w");
-    if (debug_log) {
-        fprintf(debug_log, "=== Glyphborn Debug Log ===\n");
-        fflush(debug_log);
+    const uint8_t* ptr = *cursor;
+
+    if (ptr + sizeof(uint32_t) > end) return false;
+    uint32_t vertex_count = *(uint32_t*)ptr; ptr += sizeof(uint32_t);
+
+    // Air tile: index_count + texture dims follow to match the writer, nothing else
+    if (vertex_count == 0) {
+        if (ptr + sizeof(uint32_t) + sizeof(uint16_t)*2 > end) return false;
+
+        tile->index_count   = *(uint32_t*)ptr; ptr += sizeof(uint32_t);
+        tile->texture_width = *(uint16_t*)ptr; ptr += sizeof(uint16_t);
+        tile->texture_height= *(uint16_t*)ptr; ptr += sizeof(uint16_t);
+
+        *cursor = ptr;
+        return true;
     }
 
+    size_t vbytes = (size_t)vertex_count * sizeof(Vertex);
+    if (vbytes > (size_t)(end - ptr)) return false;
+
+    Vertex* vertices = malloc(vbytes);
+    if (!vertices) return false;
+    tile->vertices = vertices;
+    tile->vertex_count = vertex_count;
+
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        vertices[v].x = *(float*)ptr; ptr += sizeof(float);
+        vertices[v].y = *(float*)ptr; ptr += sizeof(float);
+        vertices[v].z = *(float*)ptr; ptr += sizeof(float);
+        vertices[v].u = *(float*)ptr; ptr += sizeof(float);
+        vertices[v].v = *(float*)ptr; ptr += sizeof(float);
+    }
+
+    // Indices; normals, face tags and quads all follow them into the vertices
+    if (ptr + sizeof(uint32_t) > end) return false;
+    uint32_t index_count = *(uint32_t*)ptr; ptr += sizeof(uint32_t);
+
+    size_t ibytes = (size_t)index_count * sizeof(uint16_t);
+    if (ibytes > (size_t)(end - ptr)) return false;
+
+    uint16_t* indices = malloc(ibytes ? ibytes : 1);
+    if (!indices) return false;
+    tile->indices = indices;
+    tile->index_count = index_count;
+    memcpy(indices, ptr, ibytes); ptr += ibytes;
+
+    uint32_t face_count = index_count / 3;
+    for (uint32_t k = 0; k < face_count * 3; k++) {
+        if (indices[k] >= vertex_count) return false;
+    }
+
+    // Face normals (baked since v2, derived from the triangles before that)
+    Vec3* normals = malloc(face_count ? face_count * sizeof(Vec3) : 1);
+    if (!normals) return false;
+    tile->normals = normals;
+
+    if (version >= 2) {
+        size_t nbytes = (size_t)face_count * 3 * sizeof(float);
+        if (nbytes > (size_t)(end - ptr)) return false;
+
+        for (uint32_t f = 0; f < face_count; f++) {
+            normals[f].x = ((const float*)ptr)[f * 3 + 0];
+            normals[f].y = ((const float*)ptr)[f * 3 + 1];
+            normals[f].z = ((const float*)ptr)[f * 3 + 2];
+        }
+        ptr += nbytes;
+    }
+    else {
+        for (uint32_t f = 0; f < face_count; f++) {
+            const Vertex* a = &vertices[indices[f * 3 + 0]];
+            const Vertex* b = &vertices[indices[f * 3 + 1]];
+            const Vertex* c = &vertices[indices[f * 3 + 2]];
+
+            normals[f] = directional_light_face_normal(
+                (Vec3){ a->x, a->y, a->z },
+                (Vec3){ b->x, b->y, b->z },
+                (Vec3){ c->x, c->y, c->z });
+        }
+    }
+
+    // Face tags (stored since v3, derived once the texture is known before that)
+    uint8_t* face_planes = malloc(face_count ? face_count : 1);
+    if (!face_planes) return false;
+    tile->face_planes = face_planes;
+
+    if (version >= 3) {
+        if ((size_t)face_count + 1 > (size_t)(end - ptr)) return false;
+
+        memcpy(face_planes, ptr, face_count);
+        ptr += face_count;
+
+        tile->full_faces = *ptr++ & ((1u << TILE_FACE_COUNT) - 1);
+    }
+
+    // Texture dimensions
+    if (ptr + 4 > end) return false;
+    tile->texture_width  = ptr[0] | (ptr[1] << 8);
+    tile->texture_height = ptr[2] | (ptr[3] << 8);
+    ptr += 4;
+
+    size_t pixel_count = (size_t)tile->texture_width * tile->texture_height;
+    if (pixel_count > 0) {
+        size_t pbytes = pixel_count * sizeof(uint32_t);
+        if (pbytes > (size_t)(end - ptr)) return false;
+
+        uint32_t* pixels = malloc(pbytes);
+        if (!pixels) return false;
+        tile->pixels = pixels;
+        memcpy(pixels, ptr, pbytes);
+        ptr += pbytes;
+    }
+
+    if (version < 3)
+        derive_faces(tile, face_planes);
+
+    uint8_t* face_quads = malloc(face_count ? face_count : 1);
+    if (!face_quads) return false;
+    derive_quads(tile, face_quads);
+
+    derive_average_color(tile);
+
+    *cursor = ptr;
+    return true;
+}
+
+static Tileset* parse_tileset(const Blob* blob)
+{
     const uint8_t* ptr = blob->data;
     const uint8_t* end = blob->data + blob->size;
 
     if (blob->size < 4 + 2 + 2) {
-        fprintf(debug_log, "parse_tileset: too small for header\n");
-        fflush(debug_log);
         return NULL;
     }
 
@@ -31,20 +566,22 @@ static Tileset* parse_tileset(const Blob* blob)
     uint16_t version = *(uint16_t*)ptr; ptr += sizeof(uint16_t);
     uint16_t tile_count = *(uint16_t*)ptr; ptr += sizeof(uint16_t);
 
-    fprintf(debug_log, "parse_tileset: size=%zu, magic=0x%08X, version=%u, tile_count=%u\n",
-            blob->size, magic, version, tile_count);
-    fflush(debug_log);
-
-    if (magic != TILESET_MAGIC || version != 1) {
-        fprintf(debug_log, "parse_tileset: bad magic/version\n");
-        fflush(debug_log);
+    if (magic != TILESET_MAGIC || version < TILESET_VERSION_MIN || version > TILESET_VERSION_MAX) {
         return NULL;
     }
 
+    // Version 4 is used in place; no per-tile parsing or copying
+    if (version == TILESET_VERSION_VIEW) {
+        return view_tileset(blob);
+    }
+
     Tileset* tileset = malloc(sizeof(Tileset));
     if (!tileset) return NULL;
 
     tileset->tile_count = tile_count;
+    tileset->borrowed = false;
+    tileset->storage = NULL;
+    tileset->blob = NULL;
     tileset->tiles = malloc(tile_count * sizeof(TileMesh));
     if (!tileset->tiles) { free(tileset); return NULL; }
 
@@ -53,6 +590,12 @@ static Tileset* parse_tileset(const Blob* blob)
         tileset->tiles[i].vertices = NULL;
         tileset->tiles[i].indices  = NULL;
         tileset->tiles[i].pixels   = NULL;
+        tileset->tiles[i].normals  = NULL;
+        tileset->tiles[i].face_planes = NULL;
+        tileset->tiles[i].full_faces = 0;
+        tileset->tiles[i].quad_count = 0;
+        tileset->tiles[i].face_quads = NULL;
+        tileset->tiles[i].average_color = 0;
         tileset->tiles[i].vertex_count = 0;
         tileset->tiles[i].index_count  = 0;
         tileset->tiles[i].texture_width = 0;
@@ -60,112 +603,245 @@ static Tileset* parse_tileset(const Blob* blob)
     }
 
     for (uint16_t i = 0; i < tile_count; i++) {
-        TileMesh* tile = &tileset->tiles[i];
-        fprintf(debug_log, "parse_tileset: tile %u\n", i);
-        fflush(debug_log);
-
-        if (ptr + sizeof(uint32_t) > end) {
-            fprintf(debug_log, "parse_tileset: OOB before vertex_count (tile %u)\n", i);
-            fflush(debug_log);
-            break;
-        }
-
-        tile->vertex_count = *(uint32_t*)ptr; ptr += sizeof(uint32_t);
-        fprintf(debug_log, "  vertex_count=%u\n", tile->vertex_count);
-        fflush(debug_log);
-
-        if (tile->vertex_count > 0) {
-            size_t vbytes = tile->vertex_count * sizeof(Vertex);
-            if (ptr + vbytes > end) { fprintf(debug_log, "OOB vertices\n"); break; }
-            tile->vertices = malloc(vbytes);
-
-            for (uint32_t v = 0; v < tile->vertex_count; v++) {
-                tile->vertices[v].x = *(float*)ptr; ptr += sizeof(float);
-                tile->vertices[v].y = *(float*)ptr; ptr += sizeof(float);
-                tile->vertices[v].z = *(float*)ptr; ptr += sizeof(float);
-                tile->vertices[v].u = *(float*)ptr; ptr += sizeof(float);
-                tile->vertices[v].v = *(float*)ptr; ptr += sizeof(float);
-            }
-
-            // Indices
-            if (ptr + sizeof(uint32_t) > end) { fprintf(debug_log, "OOB index_count\n"); break; }
-            tile->index_count = *(uint32_t*)ptr; ptr += sizeof(uint32_t);
-
-            size_t ibytes = tile->index_count * sizeof(uint16_t);
-            if (ptr + ibytes > end) { fprintf(debug_log, "OOB indices\n"); break; }
-            tile->indices = malloc(ibytes);
-            memcpy(tile->indices, ptr, ibytes); ptr += ibytes;
-
-            // Texture dimensions
-            if (ptr + 4 > end) { fprintf(debug_log, "OOB tex dims\n"); break; }
-            tile->texture_width  = ptr[0] | (ptr[1] << 8);
-            tile->texture_height = ptr[2] | (ptr[3] << 8);
-            ptr += 4;
-            fprintf(debug_log, "  texture: %u x %u\n", tile->texture_width, tile->texture_height);
-
-            size_t pixel_count = (size_t)tile->texture_width * tile->texture_height;
-            if (pixel_count > 0) {
-                size_t pbytes = pixel_count * sizeof(uint32_t);
-                if (ptr + pbytes > end) {
-                    fprintf(debug_log, "OOB pixels\n");
-                    tile->pixels = NULL;
-                } else {
-                    tile->pixels = malloc(pbytes);
-                    memcpy(tile->pixels, ptr, pbytes);
-                    ptr += pbytes;
-                }
-            } else {
-                tile->pixels = NULL;
-            }
-
-        }
-        else {
-            // Air tile: read index_count + texture dims to match writer
-            if (ptr + sizeof(uint32_t) + sizeof(uint16_t)*2 > end) { fprintf(debug_log, "OOB air tile\n"); break; }
-
-            tile->index_count   = *(uint32_t*)ptr; ptr += sizeof(uint32_t);
-            tile->texture_width = *(uint16_t*)ptr; ptr += sizeof(uint16_t);
-            tile->texture_height= *(uint16_t*)ptr; ptr += sizeof(uint16_t);
+        if (!parse_tile(&tileset->tiles[i], version, &ptr, end)) {
+            tileset_free(tileset);
+            return NULL;
         }
     }
 
-    fprintf(debug_log, "parse_tileset: done\n");
-    fflush(debug_log);
-    if (debug_log) fclose(debug_log);
-
     return tileset;
 }
 
+static Tileset* load_tileset(AssetKind kind, uint16_t tileset_id)
+{
+    const Blob* blob = asset_get(kind, tileset_id);
+    if (!blob) return NULL;
+    return parse_tileset(blob);
+}
+
 Tileset* tileset_load_regional(uint16_t tileset_id)
 {
-    if (tileset_id >= g_Tileset_Regional_Count) return NULL;
-    return parse_tileset(&g_Tileset_Regional[tileset_id]);
+    return load_tileset(ASSET_TILESET_REGIONAL, tileset_id);
 }
 
 Tileset* tileset_load_local(uint16_t tileset_id)
 {
-    if (tileset_id >= g_Tileset_Local_Count) return NULL;
-    return parse_tileset(&g_Tileset_Local[tileset_id]);
+    return load_tileset(ASSET_TILESET_LOCAL, tileset_id);
 }
 
 Tileset* tileset_load_interior(uint16_t tileset_id)
 {
-    if (tileset_id >= g_Tileset_Interior_Count) return NULL;
-    return parse_tileset(&g_Tileset_Interior[tileset_id]);
+    return load_tileset(ASSET_TILESET_INTERIOR, tileset_id);
 }
 
 void tileset_free(Tileset* tileset)
 {
     if (!tileset) return;
 
-    for (int i = 0; i < tileset->tile_count; i++)
+    // Borrowed tiles point into the blob; their derived data lives in storage
+    for (int i = 0; !tileset->borrowed && i < tileset->tile_count; i++)
     {
         TileMesh* tile = &tileset->tiles[i];
-        free(tile->vertices);
-        free(tile->indices);
-        free(tile->pixels);
+        free((void*)tile->vertices);
+        free((void*)tile->indices);
+        free((void*)tile->pixels);
+        free((void*)tile->normals);
+        free((void*)tile->face_planes);
+        free((void*)tile->face_quads);
     }
 
+    free(tileset->storage);
+    free(tileset->blob);
     free(tileset->tiles);
     free(tileset);
-}
\ No newline at end of file
+}
+
+/**
+ * TilesetCacheEntry - One parsed tileset shared through the cache
+ * @kind, @id: Key the tileset was parsed from.
+ * @refs: Number of outstanding `tileset_acquire` calls.
+ * @tileset: The parsed tileset.
+ * @next: Next entry in the cache list.
+ */
+typedef struct TilesetCacheEntry {
+    TilesetKind kind;
+    uint16_t id;
+    uint32_t refs;
+    Tileset* tileset;
+    struct TilesetCacheEntry* next;
+} TilesetCacheEntry;
+
+static struct
+{
+    Mutex* mutex;
+    TilesetCacheEntry* entries;
+} cache;
+
+static Tileset* tileset_load(TilesetKind kind, uint16_t tileset_id)
+{
+    switch (kind)
+    {
+        case TILESET_REGIONAL: return tileset_load_regional(tileset_id);
+        case TILESET_LOCAL: return tileset_load_local(tileset_id);
+        case TILESET_INTERIOR: return tileset_load_interior(tileset_id);
+        default: return NULL;
+    }
+}
+
+/* Parse a heap copy of a blob; the tileset keeps it if its tiles point into it */
+static Tileset* tileset_parse_owned(uint8_t* data, size_t size)
+{
+    Blob blob = { data, size };
+    Tileset* tileset = parse_tileset(&blob);
+
+    if (tileset && tileset->borrowed)
+        tileset->blob = data;
+    else
+        free(data);
+
+    return tileset;
+}
+
+/* Parse @data if given (taking it over), otherwise the blob from the assets */
+static Tileset* tileset_make(TilesetKind kind, uint16_t tileset_id, uint8_t* data, size_t size)
+{
+    if (data)
+        return tileset_parse_owned(data, size);
+
+    return tileset_load(kind, tileset_id);
+}
+
+void tileset_cache_init(void)
+{
+    if (!cache.mutex)
+        cache.mutex = mutex_create();
+}
+
+void tileset_cache_free(void)
+{
+    TilesetCacheEntry* entry = cache.entries;
+    while (entry)
+    {
+        TilesetCacheEntry* next = entry->next;
+        tileset_free(entry->tileset);
+        free(entry);
+        entry = next;
+    }
+    cache.entries = NULL;
+
+    mutex_destroy(cache.mutex);
+    cache.mutex = NULL;
+}
+
+/* Caller holds the cache mutex */
+static TilesetCacheEntry* cache_find(TilesetKind kind, uint16_t tileset_id)
+{
+    for (TilesetCacheEntry* entry = cache.entries; entry; entry = entry->next)
+    {
+        if (entry->kind == kind && entry->id == tileset_id)
+            return entry;
+    }
+
+    return NULL;
+}
+
+static Tileset* cache_acquire(TilesetKind kind, uint16_t tileset_id, uint8_t* data, size_t size)
+{
+    // Without a cache every caller gets a private copy
+    if (!cache.mutex)
+        return tileset_make(kind, tileset_id, data, size);
+
+    mutex_lock(cache.mutex);
+    TilesetCacheEntry* entry = cache_find(kind, tileset_id);
+    if (entry)
+    {
+        entry->refs++;
+        mutex_unlock(cache.mutex);
+        free(data);
+        return entry->tileset;
+    }
+    mutex_unlock(cache.mutex);
+
+    // Parse unlocked so a slow parse never stalls releases on other threads
+    Tileset* tileset = tileset_make(kind, tileset_id, data, size);
+    if (!tileset)
+        return NULL;
+
+    mutex_lock(cache.mutex);
+
+    // Another thread may have parsed the same tileset in the meantime
+    entry = cache_find(kind, tileset_id);
+    if (entry)
+    {
+        entry->refs++;
+        mutex_unlock(cache.mutex);
+        tileset_free(tileset);
+        return entry->tileset;
+    }
+
+    entry = malloc(sizeof(TilesetCacheEntry));
+    if (!entry)
+    {
+        mutex_unlock(cache.mutex);
+        return tileset;
+    }
+
+    entry->kind = kind;
+    entry->id = tileset_id;
+    entry->refs = 1;
+    entry->tileset = tileset;
+    entry->next = cache.entries;
+    cache.entries = entry;
+
+    mutex_unlock(cache.mutex);
+    return tileset;
+}
+
+Tileset* tileset_acquire(TilesetKind kind, uint16_t tileset_id)
+{
+    return cache_acquire(kind, tileset_id, NULL, 0);
+}
+
+Tileset* tileset_acquire_data(TilesetKind kind, uint16_t tileset_id, uint8_t* data, size_t size)
+{
+    return cache_acquire(kind, tileset_id, data, size);
+}
+
+bool tileset_is_cached(TilesetKind kind, uint16_t tileset_id)
+{
+    if (!cache.mutex)
+        return false;
+
+    mutex_lock(cache.mutex);
+    bool cached = cache_find(kind, tileset_id) != NULL;
+    mutex_unlock(cache.mutex);
+
+    return cached;
+}
+
+void tileset_release(Tileset* tileset)
+{
+    if (!tileset) return;
+
+    if (cache.mutex)
+        mutex_lock(cache.mutex);
+
+    TilesetCacheEntry** link = &cache.entries;
+    while (*link && (*link)->tileset != tileset)
+        link = &(*link)->next;
+
+    TilesetCacheEntry* entry = *link;
+    bool last = !entry || --entry->refs == 0;
+    if (entry && last)
+        *link = entry->next;
+
+    if (cache.mutex)
+        mutex_unlock(cache.mutex);
+
+    // Private copies (no cache entry) are freed straight away
+    if (last)
+    {
+        tileset_free(tileset);
+        free(entry);
+    }
+}
@@ -0,0 +1,115 @@
+/*
+ * world_collision_test.c - Collision map storage
+ *
+ * Parses collision blobs both in place and palette-packed and checks that
+ * every flag reads back the same, with the packed blob freed before reading.
+ */
+
+#include "world/world_collision.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+#define TEST_FLAG_COUNT (MAP_LAYERS * MAP_HEIGHT * MAP_WIDTH)
+
+/* Flags of a plausible cell: solid floor, sparse walls, empty sky, one noisy layer */
+static uint8_t test_flag(int layer, int y, int x)
+{
+    if (layer == 0) return 1;
+    if (layer < 4) return (x == 0 || y == 0) ? 3 : 0;
+    if (layer == 8) return (uint8_t)((x * 7 + y * 13) & 0xFF);
+    return 0;
+}
+
+static uint8_t* test_blob(uint16_t version, size_t* size)
+{
+    size_t header = version == 1 ? 6 : 16;
+    *size = header + TEST_FLAG_COUNT;
+    uint8_t* data = malloc(*size);
+    if (!data) return NULL;
+
+    uint32_t magic = COLLISION_MAGIC;
+    memset(data, 0, header);
+    memcpy(data, &magic, sizeof(magic));
+    memcpy(data + sizeof(magic), &version, sizeof(version));
+
+    for (int layer = 0; layer < MAP_LAYERS; layer++)
+        for (int y = 0; y < MAP_HEIGHT; y++)
+            for (int x = 0; x < MAP_WIDTH; x++)
+                data[header + (layer * MAP_HEIGHT + y) * MAP_WIDTH + x] = test_flag(layer, y, x);
+
+    return data;
+}
+
+static void check_flags(const CollisionMap* map)
+{
+    bool same = true;
+    for (int layer = 0; layer < MAP_LAYERS; layer++)
+        for (int y = 0; y < MAP_HEIGHT; y++)
+            for (int x = 0; x < MAP_WIDTH; x++)
+                same &= collision_get(map, layer, y, x) == test_flag(layer, y, x);
+    CHECK(same);
+}
+
+static void test_parse(const char* name, uint16_t version, bool borrow, Arena* arena)
+{
+    int before = failures;
+
+    size_t size;
+    uint8_t* data = test_blob(version, &size);
+    Blob blob = { data, size };
+    CollisionMap* map = data ? collision_parse(&blob, arena, borrow) : NULL;
+    CHECK(map != NULL);
+
+    if (map)
+    {
+        if (borrow)
+        {
+            CHECK(map->storage == MAP_STORAGE_VIEW);
+        }
+        else
+        {
+            // A packed map no longer needs the blob
+            free(data);
+            data = NULL;
+            CHECK(map->storage == MAP_STORAGE_PACKED);
+            CHECK(collision_bytes(map) < TEST_FLAG_COUNT / 4);
+        }
+
+        check_flags(map);
+    }
+
+    printf("%s %s\n", failures == before ? "ok  " : "FAIL", name);
+
+    collision_free(map);
+    free(data);
+}
+
+int main(void)
+{
+    arena_pool_init(1);
+
+    test_parse("version 1, view", 1, true, NULL);
+    test_parse("version 2, view", 2, true, NULL);
+    test_parse("version 1, packed", 1, false, NULL);
+    test_parse("version 2, packed", 2, false, NULL);
+
+    Arena* arena = arena_acquire();
+    test_parse("version 2, packed into an arena", 2, false, arena);
+    arena_release(arena);
+
+    arena_pool_free();
+
+    if (failures)
+        fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
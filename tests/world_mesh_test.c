@@ -0,0 +1,185 @@
+/*
+ * world_mesh_test.c - Chunk mesh baking
+ *
+ * Builds cells out of hand-made tiles and checks that every index of the
+ * baked mesh points at a vertex it emitted, and that each face list stays
+ * below its plane bounds.
+ */
+
+#include "world/world_mesh.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static const uint32_t test_pixel = 0xFF808080;
+
+/* A horizontal panel through the middle of the tile; both sides are quads when @double_sided */
+static const Vertex panel_vertices[4] = {
+    { 0.0f, 0.5f, -1.0f, 0.0f, 0.0f },
+    { 1.0f, 0.5f, -1.0f, 1.0f, 0.0f },
+    { 1.0f, 0.5f,  0.0f, 1.0f, 1.0f },
+    { 0.0f, 0.5f,  0.0f, 0.0f, 1.0f },
+};
+static const uint16_t panel_indices[12] = { 0, 2, 1, 0, 3, 2, 0, 1, 2, 0, 2, 3 };
+static const Vec3 panel_normals[4] = { { 0, 1, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, -1, 0 } };
+static const uint8_t panel_planes[4] = { TILE_FACE_NONE, TILE_FACE_NONE, TILE_FACE_NONE, TILE_FACE_NONE };
+static const uint8_t panel_quads[4] = { 0, 0, 1, 1 };
+
+static TileMesh test_panel(bool double_sided)
+{
+    TileMesh tile = {
+        .vertices = panel_vertices,
+        .vertex_count = 4,
+        .indices = panel_indices,
+        .index_count = double_sided ? 12 : 6,
+        .pixels = &test_pixel,
+        .texture_width = 1,
+        .texture_height = 1,
+        .normals = panel_normals,
+        .face_planes = panel_planes,
+        .face_quads = panel_quads,
+        .quad_count = double_sided ? 2 : 1,
+    };
+
+    for (int q = 0; q < tile.quad_count; q++)
+    {
+        tile.quads[q] = (TileQuad){
+            .axis = 1,
+            .normal_sign = q == 0 ? 1 : -1,
+            .offset = 0.5f,
+            .uv = { { 1, 0, 0 }, { 0, 1, 0 } },
+            .face = (uint32_t)q * 2,
+        };
+    }
+
+    return tile;
+}
+
+/* Geometry blob with tile 1 of the regional tileset wherever @place says so */
+static uint8_t* test_blob(bool (*place)(int layer, int y, int x), size_t* size)
+{
+    *size = 16 + (size_t)MAP_LAYERS * MAP_HEIGHT * MAP_WIDTH * sizeof(TileRef);
+    uint8_t* data = aligned_alloc(16, *size);
+    if (!data) return NULL;
+
+    memset(data, 0, *size);
+    uint32_t magic = GEOMETRY_MAGIC;
+    uint16_t version = 2;
+    memcpy(data, &magic, sizeof(magic));
+    memcpy(data + sizeof(magic), &version, sizeof(version));
+
+    TileRef* tiles = (TileRef*)(data + 16);
+    for (int layer = 0; layer < MAP_LAYERS; layer++)
+        for (int y = 0; y < MAP_HEIGHT; y++)
+            for (int x = 0; x < MAP_WIDTH; x++)
+                if (place(layer, y, x))
+                    tiles[(layer * MAP_HEIGHT + y) * MAP_WIDTH + x] = (TileRef){ 1 };
+
+    return data;
+}
+
+static void check_mesh(const ChunkMesh* mesh, uint32_t min_faces)
+{
+    CHECK(mesh->built);
+    CHECK(mesh->index_count % 3 == 0);
+    CHECK(mesh->index_count / 3 >= min_faces);
+
+    bool in_range = true;
+    for (uint32_t i = 0; i < mesh->index_count; i++)
+        in_range &= mesh->indices[i] < mesh->vertex_count;
+    CHECK(in_range);
+    // Every triangle of a bounded face list lies at or below its normal's plane
+    bool bounded = true;
+    for (int facing = 0; facing < CAMERA_CARDINAL_COUNT; facing++)
+    {
+        const ChunkFaces* faces = &mesh->views[facing];
+
+        for (int b = 0; b < CHUNK_BRICK_COUNT; b++)
+        {
+            const ChunkBrick* brick = &mesh->bricks[b];
+            uint16_t plane_count = brick->facing_count[facing];
+            if (plane_count == CHUNK_FACING_MIXED)
+                continue;
+
+            const ChunkFacing* planes = &faces->facing[brick->facing_first[facing]];
+            for (uint32_t f = brick->view_first[facing]; f < brick->view_first[facing] + brick->view_count[facing]; f++)
+            {
+                const ChunkFacing* plane = NULL;
+                for (uint16_t p = 0; p < plane_count; p++)
+                    if (planes[p].normal == faces->face_normals[f])
+                        plane = &planes[p];
+
+                bounded &= plane != NULL;
+                if (!plane)
+                    continue;
+
+                for (int k = 0; k < 3; k++)
+                {
+                    const RasterVertex* v = &mesh->vertices[brick->vertex_first + faces->indices[f * 3 + k]];
+                    bounded &= vec3_dot(mesh->normals[plane->normal], (Vec3){ v->x, v->y, v->z }) <= plane->height;
+                }
+            }
+        }
+    }
+    CHECK(bounded);
+}
+
+static void test_build(const char* name, bool double_sided, bool (*place)(int, int, int), uint32_t min_faces)
+{
+    TileMesh tiles[2] = { { 0 }, test_panel(double_sided) };
+    Tileset tileset = { .tiles = tiles, .tile_count = 2 };
+
+    size_t size;
+    uint8_t* data = test_blob(place, &size);
+    Blob blob = { data, size };
+    GeometryMap* geometry = data ? geometry_parse(&blob, NULL, false) : NULL;
+    free(data);
+    CHECK(geometry != NULL);
+    if (!geometry)
+        return;
+
+    ChunkSource cell = { .geo = geometry, .regional = &tileset };
+    const ChunkSource* neighbours[CHUNK_SIDE_COUNT] = { 0 };
+
+    ChunkMesh mesh;
+    memset(&mesh, 0, sizeof(mesh));
+
+    int before = failures;
+    CHECK(chunk_mesh_build(&mesh, &cell, neighbours));
+    check_mesh(&mesh, min_faces);
+    printf("%s %s\n", failures == before ? "ok  " : "FAIL", name);
+
+    chunk_mesh_free(&mesh);
+    geometry_free(geometry);
+}
+
+static bool place_one(int layer, int y, int x) { return layer == 0 && y == 0 && x == 0; }
+static bool place_layer(int layer, int y, int x) { (void)y; (void)x; return layer == 0; }
+static bool place_checker(int layer, int y, int x) { return layer % 2 == 0 && (x + y) % 2 == 0; }
+static bool place_row(int layer, int y, int x) { (void)x; return layer == 3 && y == 5; }
+
+int main(void)
+{
+    arena_pool_init(4);
+
+    test_build("one-sided panel", false, place_one, 2);
+    test_build("double-sided panel", true, place_one, 4);
+    test_build("double-sided layer (merged rectangles)", true, place_layer, 4);
+    test_build("double-sided checkerboard (lone squares)", true, place_checker, 4);
+    test_build("double-sided row (1 x n rectangle)", true, place_row, 4);
+
+    arena_pool_free();
+
+    if (failures)
+        fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,340 @@
+#!/usr/bin/env python3
+"""Upgrade world data to the formats the engine uses in place.
+
+Tilesets (.gbts, magic "GLTS") of versions 1-3 are rewritten as version 4,
+whose arrays the engine points into instead of copying (see
+source/world/world_tileset.c):
+
+    TilesetHeaderV4   16 bytes: magic, version, tile count, total size, reserved
+    TilesetTileV4[]   36 bytes each: byte offsets and counts of the tile's arrays
+    arrays            vertices, indices, normals, face tags, pixels, each
+                      starting on a 16-byte boundary from the blob start
+
+Data the engine derives at load for older versions (face normals before
+version 2, face tags and full-face masks before version 3) is computed here
+in float32 with the same operations and order, so a converted tileset loads
+bit-identically.
+
+Layouts (geometry "GBMG" and collision "GBMC") of version 1 are rewritten as
+version 2, whose header is padded from 6 to 16 bytes so the tiles that follow
+stay aligned for use in place (see source/world/world_geometry.c).
+
+Files already in the current format are left untouched.
+
+The blob tables in source/generated record each embedded file's size, so the
+entry of every file rewritten here is updated to its new size.
+
+pack_assets.py runs the same conversion on every entry it packs.
+
+Usage: convert_assets.py [--data DIR] [--generated DIR] [--check]
+"""
+
+import argparse
+import math
+import os
+import re
+import struct
+import sys
+
+TILESET_MAGIC = 0x53544C47  # "GLTS"
+TILESET_VIEW = 4
+VIEW_ALIGN = 16
+
+TILESET_HEADER_V4 = struct.Struct("<IHHII")
+TILESET_TILE_V4 = struct.Struct("<IIIIIIIHHB3x")
+
+GEOMETRY_MAGIC = 0x474D4247  # "GBMG"
+COLLISION_MAGIC = 0x434D4247  # "GBMC"
+LAYOUT_HEADER_V1 = 6
+LAYOUT_HEADER_V2 = 16
+
+TILE_FACE_COUNT = 6
+TILE_FACE_NONE = 0xFF
+TILE_FACE_EPSILON = 1e-4
+
+
+class FormatError(Exception):
+    pass
+
+
+def f32(x):
+    """Round to float32, as every float operation in the engine does."""
+    return struct.unpack("<f", struct.pack("<f", x))[0]
+
+
+EPSILON = f32(TILE_FACE_EPSILON)
+
+
+def f32_sub(a, b):
+    return f32(a - b)
+
+
+def f32_cross(a, b):
+    """vec3_cross; float32 products and differences are exact in double before rounding."""
+    return (
+        f32(f32(a[1] * b[2]) - f32(a[2] * b[1])),
+        f32(f32(a[2] * b[0]) - f32(a[0] * b[2])),
+        f32(f32(a[0] * b[1]) - f32(a[1] * b[0])),
+    )
+
+
+def f32_length(v):
+    """vec3_length"""
+    return f32(math.sqrt(f32(f32(f32(v[0] * v[0]) + f32(v[1] * v[1])) + f32(v[2] * v[2]))))
+
+
+def face_normal(a, b, c):
+    """directional_light_face_normal"""
+    n = f32_cross(tuple(f32_sub(b[i], a[i]) for i in range(3)), tuple(f32_sub(c[i], a[i]) for i in range(3)))
+    len_sq = f32(f32(f32(n[0] * n[0]) + f32(n[1] * n[1])) + f32(n[2] * n[2]))
+    if len_sq < f32(1e-6):
+        return (0.0, 0.0, 0.0)
+
+    length = f32_length(n)
+    if length == 0.0:
+        return (0.0, 0.0, 0.0)
+    return tuple(f32(x / length) for x in n)
+
+
+def classify_face(a, b, c, n):
+    """classify_face: the tile face the triangle lies on and faces out of"""
+    bounds = (0.0, 1.0, 0.0, 1.0, -1.0, 0.0)
+
+    for face in range(TILE_FACE_COUNT):
+        axis = face // 2
+        bound = bounds[face]
+        outward = 1.0 if face & 1 else -1.0
+
+        if (abs(f32_sub(a[axis], bound)) < EPSILON and
+                abs(f32_sub(b[axis], bound)) < EPSILON and
+                abs(f32_sub(c[axis], bound)) < EPSILON and
+                f32(n[axis] * outward) > 0.5):
+            return face
+
+    return TILE_FACE_NONE
+
+
+def derive_faces(vertices, indices, normals, pixels):
+    """derive_faces: per-triangle face tags and the mask of full opaque faces"""
+    covered = [0.0] * TILE_FACE_COUNT
+    planes = bytearray()
+
+    for f in range(len(indices) // 3):
+        a, b, c = (vertices[indices[f * 3 + k]] for k in range(3))
+        face = classify_face(a, b, c, normals[f])
+        planes.append(face)
+
+        if face == TILE_FACE_NONE:
+            continue
+
+        cross = f32_cross(tuple(f32_sub(b[i], a[i]) for i in range(3)), tuple(f32_sub(c[i], a[i]) for i in range(3)))
+        covered[face] = f32(covered[face] + f32(0.5 * f32_length(cross)))
+
+    opaque = pixels is not None and all((p >> 24) == 0xFF for p in pixels)
+
+    full = 0
+    for face in range(TILE_FACE_COUNT):
+        if opaque and covered[face] > f32(1.0 - EPSILON):
+            full |= 1 << face
+
+    return bytes(planes), full
+
+
+class Reader:
+    def __init__(self, data, offset):
+        self.data = data
+        self.offset = offset
+
+    def take(self, fmt, count=1):
+        size = struct.calcsize("<" + fmt) * count
+        if self.offset + size > len(self.data):
+            raise FormatError("truncated")
+        values = struct.unpack_from("<" + fmt * count, self.data, self.offset)
+        self.offset += size
+        return values
+
+
+def read_tileset(data):
+    """Tiles of a version 1-3 tileset, each a dict of its arrays, as parse_tileset reads them."""
+    magic, version, tile_count = struct.unpack_from("<IHH", data, 0)
+    r = Reader(data, 8)
+    tiles = []
+
+    for _ in range(tile_count):
+        (vertex_count,) = r.take("I")
+
+        if vertex_count == 0:
+            r.take("IHH")
+            tiles.append(None)
+            continue
+
+        flat = r.take("f", vertex_count * 5)
+        vertices = [flat[v * 5:v * 5 + 5] for v in range(vertex_count)]
+
+        (index_count,) = r.take("I")
+        indices = r.take("H", index_count)
+        face_count = index_count // 3
+
+        if any(i >= vertex_count for i in indices[:face_count * 3]):
+            raise FormatError("index out of range")
+
+        if version >= 2:
+            flat = r.take("f", face_count * 3)
+            normals = [flat[f * 3:f * 3 + 3] for f in range(face_count)]
+        else:
+            normals = [face_normal(*(vertices[indices[f * 3 + k]] for k in range(3))) for f in range(face_count)]
+
+        planes = full = None
+        if version >= 3:
+            planes = bytes(r.take("B", face_count))
+            (full,) = r.take("B")
+            full &= (1 << TILE_FACE_COUNT) - 1
+
+        width, height = r.take("HH")
+        pixels = r.take("I", width * height) if width * height else None
+
+        if planes is None:
+            planes, full = derive_faces(vertices, indices, normals, pixels)
+
+        tiles.append({
+            "vertices": vertices,
+            "indices": indices,
+            "normals": normals,
+            "planes": planes,
+            "full": full,
+            "width": width,
+            "height": height,
+            "pixels": pixels,
+        })
+
+    return tiles
+
+
+def write_tileset_v4(tiles):
+    body = bytearray()
+    start = TILESET_HEADER_V4.size + TILESET_TILE_V4.size * len(tiles)
+    records = []
+
+    def place(blob):
+        if not blob:
+            return 0
+        body.extend(b"\0" * (-(start + len(body)) % VIEW_ALIGN))
+        offset = start + len(body)
+        body.extend(blob)
+        return offset
+
+    for tile in tiles:
+        if tile is None:
+            records.append(TILESET_TILE_V4.pack(0, 0, 0, 0, 0, 0, 0, 0, 0, 0))
+            continue
+
+        vertex_offset = place(struct.pack("<%df" % (len(tile["vertices"]) * 5), *(x for v in tile["vertices"] for x in v)))
+        index_offset = place(struct.pack("<%dH" % len(tile["indices"]), *tile["indices"]))
+        normal_offset = place(struct.pack("<%df" % (len(tile["normals"]) * 3), *(x for n in tile["normals"] for x in n)))
+        plane_offset = place(tile["planes"])
+        pixel_offset = place(struct.pack("<%dI" % len(tile["pixels"]), *tile["pixels"]) if tile["pixels"] else b"")
+
+        records.append(TILESET_TILE_V4.pack(
+            vertex_offset, len(tile["vertices"]),
+            index_offset, len(tile["indices"]),
+            normal_offset, plane_offset, pixel_offset,
+            tile["width"], tile["height"], tile["full"]))
+
+    size = start + len(body)
+    header = TILESET_HEADER_V4.pack(TILESET_MAGIC, TILESET_VIEW, len(tiles), size, 0)
+    return header + b"".join(records) + bytes(body)
+
+
+def upgrade_tileset(data):
+    """Version 4 form of a tileset blob, or @data itself if it is not an older tileset."""
+    if len(data) < 8:
+        return data
+
+    magic, version = struct.unpack_from("<IH", data, 0)
+    if magic != TILESET_MAGIC or not 1 <= version < TILESET_VIEW:
+        return data
+
+    return write_tileset_v4(read_tileset(data))
+
+
+def upgrade_layout(data):
+    """Version 2 form of a geometry or collision blob, or @data itself if it is not a version 1 one."""
+    if len(data) < LAYOUT_HEADER_V1:
+        return data
+
+    magic, version = struct.unpack_from("<IH", data, 0)
+    if magic not in (GEOMETRY_MAGIC, COLLISION_MAGIC) or version != 1:
+        return data
+
+    header = struct.pack("<IH", magic, 2).ljust(LAYOUT_HEADER_V2, b"\0")
+    return header + data[LAYOUT_HEADER_V1:]
+
+
+def upgrade(path, data):
+    """Upgraded contents of the data file at @path."""
+    if os.sep + "tilesets" + os.sep in path:
+        return upgrade_tileset(data)
+    if os.sep + "layouts" + os.sep in path:
+        return upgrade_layout(data)
+    return data
+
+
+def update_tables(generated, path, size):
+    """Set the size next to @path's linked-in symbol in the generated blob tables."""
+    symbol = "_binary_" + re.sub(r"[^A-Za-z0-9]", "_", os.path.normpath(path)) + "_start"
+    pattern = re.compile(r"(\b" + symbol + r",\s*)\d+")
+
+    for name in sorted(os.listdir(generated)):
+        if not name.endswith(".c"):
+            continue
+
+        table = os.path.join(generated, name)
+        with open(table) as f:
+            source = f.read()
+
+        updated = pattern.sub(lambda m: m.group(1) + str(size), source)
+        if updated != source:
+            with open(table, "w") as f:
+                f.write(updated)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Upgrade world data to the formats the engine uses in place.")
+    parser.add_argument("--data", default="data", help="data directory (default: data)")
+    parser.add_argument("--generated", default="source/generated", help="generated blob tables (default: source/generated)")
+    parser.add_argument("--check", action="store_true", help="only list files that need upgrading; fail if any do")
+    args = parser.parse_args()
+
+    stale = 0
+    for root, _, files in os.walk(args.data):
+        for name in sorted(files):
+            if not name.endswith(".bin"):
+                continue
+
+            path = os.path.join(root, name)
+            with open(path, "rb") as f:
+                data = f.read()
+
+            try:
+                upgraded = upgrade(path, data)
+            except FormatError as e:
+                sys.exit(f"convert_assets: {path}: {e}")
+
+            if upgraded == data:
+                continue
+
+            stale += 1
+            print(f"convert_assets: {path} ({len(data)} -> {len(upgraded)} bytes)")
+            if not args.check:
+                with open(path + ".tmp", "wb") as f:
+                    f.write(upgraded)
+                os.replace(path + ".tmp", path)
+                if os.path.isdir(args.generated):
+                    update_tables(args.generated, path, len(upgraded))
+
+    if args.check and stale:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
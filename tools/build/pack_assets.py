@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""Pack the world data into a .gbpak archive.
+
+Reads the registries in data/registry (the same ones embed_data.py turns into
+the generated blob tables) and writes one archive holding every valid entry,
+plus the world matrix and headers. The layout mirrors includes/assets.h:
+
+    AssetPackHeader   32 bytes
+    entry data        each entry aligned to --align bytes
+    AssetPackEntry[]  24 bytes each, sorted by (kind, id)
+
+All integers are little-endian; checksums are zlib CRC-32. Entries in older
+formats are upgraded on the way in (see convert_assets.py), so the pack only
+holds data the engine can use in place.
+
+Usage: pack_assets.py [--data DIR] [--align N] OUTPUT
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+import zlib
+
+import convert_assets
+
+MAGIC = 0x4B504247  # "GBPK"
+VERSION = 1
+ALIGN = 16
+
+HEADER = struct.Struct("<IHHIIQQ")
+ENTRY = struct.Struct("<HHIQQ")
+
+# AssetKind values, in enum order
+GEOMETRY, COLLISION, TILESET_REGIONAL, TILESET_LOCAL, TILESET_INTERIOR, WORLD_MATRIX, WORLD_HEADERS = range(7)
+
+# kind -> (registry file, path of an entry relative to the data directory)
+REGISTRIES = {
+    GEOMETRY: ("geometry.json", lambda label: os.path.join("layouts", label, "geometry.bin")),
+    COLLISION: ("collision.json", lambda label: os.path.join("layouts", label, "collision.bin")),
+    TILESET_REGIONAL: ("tileset_regional.json", lambda label: os.path.join("tilesets", "regional", label + ".bin")),
+    TILESET_LOCAL: ("tileset_local.json", lambda label: os.path.join("tilesets", "local", label + ".bin")),
+    TILESET_INTERIOR: ("tileset_interior.json", lambda label: os.path.join("tilesets", "interior", label + ".bin")),
+}
+
+# kind -> conversion to the format used in place
+UPGRADES = {
+    GEOMETRY: convert_assets.upgrade_layout,
+    COLLISION: convert_assets.upgrade_layout,
+    TILESET_REGIONAL: convert_assets.upgrade_tileset,
+    TILESET_LOCAL: convert_assets.upgrade_tileset,
+    TILESET_INTERIOR: convert_assets.upgrade_tileset,
+}
+
+SINGLES = {
+    WORLD_MATRIX: "world_matrix.mtx",
+    WORLD_HEADERS: "world_headers.hdr",
+}
+
+
+def collect(data_dir):
+    """List (kind, id, path) for everything that goes into the pack."""
+    entries = []
+
+    for kind, (registry, path_of) in REGISTRIES.items():
+        with open(os.path.join(data_dir, "registry", registry)) as f:
+            for item in json.load(f)["Entries"]:
+                if not item.get("Valid", True):
+                    continue
+                entries.append((kind, item["Index"], os.path.join(data_dir, path_of(item["Label"]))))
+
+    for kind, name in SINGLES.items():
+        entries.append((kind, 0, os.path.join(data_dir, name)))
+
+    entries.sort(key=lambda e: (e[0], e[1]))
+
+    for a, b in zip(entries, entries[1:]):
+        if a[:2] == b[:2]:
+            sys.exit(f"pack_assets: duplicate id {a[1]} for kind {a[0]}")
+
+    return entries
+
+
+def pad(out, align):
+    out.write(b"\0" * (-out.tell() % align))
+
+
+def write_pack(path, entries, align):
+    toc = []
+
+    with open(path + ".tmp", "wb") as out:
+        out.write(b"\0" * HEADER.size)
+
+        for kind, index, source in entries:
+            if not 0 <= index <= 0xFFFF:
+                sys.exit(f"pack_assets: id {index} of {source} does not fit 16 bits")
+
+            with open(source, "rb") as f:
+                data = f.read()
+
+            try:
+                data = UPGRADES.get(kind, lambda d: d)(data)
+            except convert_assets.FormatError as e:
+                sys.exit(f"pack_assets: {source}: {e}")
+
+            pad(out, align)
+            toc.append(ENTRY.pack(kind, index, zlib.crc32(data), out.tell(), len(data)))
+            out.write(data)
+
+        pad(out, align)
+        toc_offset = out.tell()
+        toc_bytes = b"".join(toc)
+        out.write(toc_bytes)
+
+        size = out.tell()
+        out.seek(0)
+        out.write(HEADER.pack(MAGIC, VERSION, align, len(toc), zlib.crc32(toc_bytes), toc_offset, size))
+
+    os.replace(path + ".tmp", path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack the world data into a .gbpak archive.")
+    parser.add_argument("output")
+    parser.add_argument("--data", default="data", help="data directory (default: data)")
+    parser.add_argument("--align", type=int, default=ALIGN, help=f"entry alignment, a multiple of {ALIGN}")
+    args = parser.parse_args()
+
+    if args.align <= 0 or args.align % ALIGN or args.align > 0xFFFF:
+        sys.exit(f"pack_assets: --align must be a positive multiple of {ALIGN}")
+
+    entries = collect(args.data)
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    write_pack(args.output, entries, args.align)
+    print(f"pack_assets: {len(entries)} entries -> {args.output}")
+
+
+if __name__ == "__main__":
+    main()